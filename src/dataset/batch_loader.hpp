@@ -0,0 +1,254 @@
+/*
+ * batch_loader.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_BATCH_LOADER_HPP_
+#define SRC_BATCH_LOADER_HPP_
+
+#include <Eigen/Dense>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <sys/mman.h>
+
+#include "tensor_file.hpp"
+
+namespace neural
+{
+
+/* Block Shuffle Sampler */
+
+// Visits the blocks of block_size consecutive samples in random order and shuffles the
+// samples within each block. Reads stay close together in the file, which keeps page
+// faults on a mapped dataset down while still mixing the data every epoch.
+class BlockShuffleSampler
+{
+public :
+	BlockShuffleSampler(size_t number_of_samples_, size_t block_size_ = 4096, unsigned int seed = 0)
+		: number_of_samples{number_of_samples_}
+		, block_size{std::max<size_t>(block_size_, 1)}
+		, gen{seed}
+	{}
+
+	// Order of the samples for the next epoch.
+	const std::vector<size_t>& next_epoch()
+	{
+		size_t number_of_blocks = (number_of_samples + block_size - 1)/block_size;
+		std::vector<size_t> blocks(number_of_blocks);
+		std::iota(blocks.begin(), blocks.end(), 0);
+		std::shuffle(blocks.begin(), blocks.end(), gen);
+
+		order.clear();
+		order.reserve(number_of_samples);
+		for(size_t b : blocks)
+		{
+			size_t begin = b*block_size, end = std::min(begin + block_size, number_of_samples);
+			size_t first = order.size();
+			for(size_t i = begin; i < end; ++i) order.push_back(i);
+			std::shuffle(order.begin() + first, order.end(), gen);
+		}
+		return order;
+	}
+
+	size_t size() const { return number_of_samples; }
+
+private :
+	size_t number_of_samples;
+	size_t block_size;
+	std::default_random_engine gen;
+	std::vector<size_t> order;
+};
+
+/* Batch Loader */
+
+// A background thread gathers the sampled rows of the inputs and targets into one of two
+// 64 byte aligned, page-locked buffers while the trainer works on the other one. The
+// batch returned by next() stays valid until the following call to next().
+template <typename ScalarType>
+class BatchLoader
+{
+public :
+	using MatrixType = Eigen::Map<const Eigen::Matrix<ScalarType, Eigen::Dynamic, Eigen::Dynamic>, Eigen::Aligned64>;
+
+	struct Batch {
+		// sample_size x size, one sample per column.
+		MatrixType inputs() const { return MatrixType(input_data, input_size, size); }
+		MatrixType targets() const { return MatrixType(target_data, target_size, size); }
+
+		const ScalarType* input_data = nullptr;
+		const ScalarType* target_data = nullptr;
+		size_t input_size = 0;
+		size_t target_size = 0;
+		size_t size = 0;
+		size_t epoch = 0;
+	};
+
+	BatchLoader(const MappedTensor<ScalarType>& inputs_, const MappedTensor<ScalarType>& targets_,
+				size_t batch_size_, BlockShuffleSampler sampler_, size_t number_of_epochs_ = 1)
+		: inputs{inputs_}
+		, targets{targets_}
+		, batch_size{batch_size_}
+		, number_of_epochs{number_of_epochs_}
+		, sampler{std::move(sampler_)}
+	{
+		assert(inputs.number_of_samples() == targets.number_of_samples() && sampler.size() == inputs.number_of_samples());
+		assert(batch_size > 0);
+		if(batch_size == 0)
+		{
+			std::cout << "Batch size must be positive. No batches will be loaded." << std::endl;
+			finished = true;
+			return;
+		}
+		for(auto& slot : slots)
+		{
+			slot.inputs = allocate(inputs.sample_size()*batch_size, slot.input_bytes);
+			slot.targets = allocate(targets.sample_size()*batch_size, slot.target_bytes);
+		}
+		producer = std::thread(&BatchLoader::produce, this);
+	}
+
+	BatchLoader(const BatchLoader&) = delete;
+	BatchLoader& operator=(const BatchLoader&) = delete;
+
+	~BatchLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		changed.notify_all();
+		if(producer.joinable()) producer.join();
+		for(auto& slot : slots)
+		{
+			if(!slot.inputs) continue;
+			release(slot.inputs, slot.input_bytes);
+			release(slot.targets, slot.target_bytes);
+		}
+	}
+
+	// Hands the previous batch back to the loader and waits for the next one.
+	// Returns false once every epoch has been delivered.
+	bool next(Batch& batch)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if(consuming >= 0)
+		{
+			slots[consuming].full = false;
+			consuming = -1;
+			changed.notify_all();
+		}
+
+		Slot& slot = slots[next_slot];
+		changed.wait(lock, [&]() { return slot.full || finished; });
+		if(!slot.full) return false;
+
+		consuming = next_slot;
+		next_slot = 1 - next_slot;
+		batch.input_data = slot.inputs;
+		batch.target_data = slot.targets;
+		batch.input_size = inputs.sample_size();
+		batch.target_size = targets.sample_size();
+		batch.size = slot.size;
+		batch.epoch = slot.epoch;
+		return true;
+	}
+
+private :
+	struct Slot {
+		ScalarType* inputs = nullptr;
+		ScalarType* targets = nullptr;
+		size_t input_bytes = 0;
+		size_t target_bytes = 0;
+		size_t size = 0;
+		size_t epoch = 0;
+		bool full = false;
+	};
+
+	static ScalarType* allocate(size_t count, size_t& bytes)
+	{
+		bytes = std::max<size_t>((count*sizeof(ScalarType) + 63)/64*64, 64);
+		void* p = std::aligned_alloc(64, bytes);
+		assert(p);
+		// Best effort: page-locking fails silently beyond RLIMIT_MEMLOCK.
+		mlock(p, bytes);
+		return static_cast<ScalarType*>(p);
+	}
+
+	static void release(ScalarType* p, size_t bytes)
+	{
+		munlock(p, bytes);
+		std::free(p);
+	}
+
+	void produce()
+	{
+		int fill = 0;
+		for(size_t epoch = 0; epoch < number_of_epochs; ++epoch)
+		{
+			const std::vector<size_t>& order = sampler.next_epoch();
+			for(size_t first = 0; first < order.size(); first += batch_size)
+			{
+				Slot& slot = slots[fill];
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&]() { return !slot.full || stopping; });
+					if(stopping) return;
+				}
+
+				// Gather outside the lock; this slot belongs to the producer until it is marked full.
+				slot.size = std::min(batch_size, order.size() - first);
+				slot.epoch = epoch;
+				for(size_t k = 0; k < slot.size; ++k)
+				{
+					size_t i = order[first + k];
+					std::memcpy(slot.inputs + k*inputs.sample_size(), inputs.sample(i), inputs.sample_size()*sizeof(ScalarType));
+					std::memcpy(slot.targets + k*targets.sample_size(), targets.sample(i), targets.sample_size()*sizeof(ScalarType));
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					slot.full = true;
+				}
+				changed.notify_all();
+				fill = 1 - fill;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished = true;
+		}
+		changed.notify_all();
+	}
+
+	const MappedTensor<ScalarType>& inputs;
+	const MappedTensor<ScalarType>& targets;
+	size_t batch_size;
+	size_t number_of_epochs;
+	BlockShuffleSampler sampler;
+
+	Slot slots[2];
+	int next_slot = 0;
+	int consuming = -1;
+	bool finished = false;
+	bool stopping = false;
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::thread producer;
+};
+
+}
+
+#endif /* SRC_BATCH_LOADER_HPP_ */
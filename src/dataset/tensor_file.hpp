@@ -0,0 +1,188 @@
+/*
+ * tensor_file.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_TENSOR_FILE_HPP_
+#define SRC_TENSOR_FILE_HPP_
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace neural
+{
+
+/*
+ *  Tensor file format.
+ *
+ *  A 64 byte header followed by number_of_samples samples of sample_size scalars each,
+ *  stored contiguously. This is exactly the layout of a column-major
+ *  sample_size x number_of_samples Eigen matrix, the one sample per column convention
+ *  used by the trainers, so a mapped file can be used in place without copying.
+ *
+ *      magic:char[4] = "NTSR"  version:u32  scalar:u32 (4 = float, 8 = double)
+ *      reserved:u32  number_of_samples:u64  sample_size:u64  padding to 64 bytes
+ */
+
+struct TensorFileHeader {
+	static constexpr char magic_value[4] = {'N', 'T', 'S', 'R'};
+	static constexpr uint32_t current_version = 1;
+
+	char magic[4];
+	uint32_t version;
+	uint32_t scalar_size;
+	uint32_t reserved;
+	uint64_t number_of_samples;
+	uint64_t sample_size;
+	char padding[32];
+};
+
+static_assert(sizeof(TensorFileHeader) == 64);
+
+// Writes one sample per column of samples.
+template <typename Derived>
+bool save_tensor(const std::string& filename, const Eigen::MatrixBase<Derived>& samples)
+{
+	using ScalarType = typename Derived::Scalar;
+	std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!file.is_open())
+	{
+		std::cout << "File not open. Tensor cannot be saved." << std::endl;
+		return false;
+	}
+
+	TensorFileHeader header {};
+	std::memcpy(header.magic, TensorFileHeader::magic_value, 4);
+	header.version = TensorFileHeader::current_version;
+	header.scalar_size = sizeof(ScalarType);
+	header.number_of_samples = samples.cols();
+	header.sample_size = samples.rows();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	Eigen::Matrix<ScalarType, Eigen::Dynamic, Eigen::Dynamic> data = samples;
+	file.write(reinterpret_cast<const char*>(data.data()), data.size()*sizeof(ScalarType));
+	return file.good();
+}
+
+/* Memory-mapped tensor */
+
+// Read-only view of a tensor file. The data is paged in by the OS on first touch.
+template <typename ScalarType>
+class MappedTensor
+{
+public :
+	using MatrixType = Eigen::Map<const Eigen::Matrix<ScalarType, Eigen::Dynamic, Eigen::Dynamic>>;
+
+	MappedTensor() {}
+
+	MappedTensor(const std::string& filename) { open(filename); }
+
+	MappedTensor(const MappedTensor&) = delete;
+	MappedTensor& operator=(const MappedTensor&) = delete;
+
+	MappedTensor(MappedTensor&& other) { *this = std::move(other); }
+
+	MappedTensor& operator=(MappedTensor&& other)
+	{
+		close();
+		std::swap(mapping, other.mapping);
+		std::swap(mapping_size, other.mapping_size);
+		std::swap(header, other.header);
+		return *this;
+	}
+
+	~MappedTensor() { close(); }
+
+	bool open(const std::string& filename)
+	{
+		close();
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if(fd < 0)
+		{
+			std::cout << "File not open. Tensor cannot be read." << std::endl;
+			return false;
+		}
+
+		struct stat st;
+		bool ok = fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TensorFileHeader);
+		if(ok)
+		{
+			void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			ok = p != MAP_FAILED;
+			if(ok)
+			{
+				mapping = p;
+				mapping_size = st.st_size;
+			}
+		}
+		::close(fd);
+
+		if(ok)
+		{
+			std::memcpy(&header, mapping, sizeof(header));
+			// Compared by division, the product of the sizes in a damaged header can overflow.
+			size_t capacity = (mapping_size - sizeof(TensorFileHeader))/sizeof(ScalarType);
+			ok = std::memcmp(header.magic, TensorFileHeader::magic_value, 4) == 0
+				&& header.version == TensorFileHeader::current_version
+				&& header.scalar_size == sizeof(ScalarType)
+				&& (header.sample_size == 0 || header.number_of_samples <= capacity/header.sample_size);
+		}
+		if(!ok)
+		{
+			std::cout << "Invalid tensor file " << filename << "." << std::endl;
+			close();
+		}
+		return ok;
+	}
+
+	void close()
+	{
+		if(mapping) munmap(mapping, mapping_size);
+		mapping = nullptr;
+		mapping_size = 0;
+		header = TensorFileHeader {};
+	}
+
+	// Tell the OS how the samples will be read, e.g. MADV_SEQUENTIAL or MADV_RANDOM.
+	void advise(int advice) const { if(mapping) madvise(mapping, mapping_size, advice); }
+
+	bool is_open() const { return mapping != nullptr; }
+	size_t number_of_samples() const { return header.number_of_samples; }
+	size_t sample_size() const { return header.sample_size; }
+
+	const ScalarType* data() const
+	{
+		return reinterpret_cast<const ScalarType*>(static_cast<const char*>(mapping) + sizeof(TensorFileHeader));
+	}
+
+	const ScalarType* sample(size_t i) const
+	{
+		assert(i < number_of_samples());
+		return data() + i*sample_size();
+	}
+
+	// The whole file as a sample_size x number_of_samples matrix, without copying.
+	MatrixType matrix() const { return MatrixType(data(), sample_size(), number_of_samples()); }
+
+private :
+	void* mapping = nullptr;
+	size_t mapping_size = 0;
+	TensorFileHeader header {};
+};
+
+}
+
+#endif /* SRC_TENSOR_FILE_HPP_ */
@@ -0,0 +1,36 @@
+//
+//  analysis.cpp
+//  Analysis
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Per-layer statistics of a saved asteroids population.
+//
+//  usage: analysis [checkpoint] [bins range]
+//
+
+#include <iostream>
+#include <string>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/population_statistics.hpp"
+
+using namespace neural;
+
+// The network of the asteroids example.
+using NN = NeuralNetwork<SigmoidLayer<16,30>, TanhLayer<30,2>>;
+
+int main(int argc, char** argv)
+{
+	std::string filename = argc > 1 ? argv[1] : "parameters-v1.txt";
+	double range = argc > 2 ? std::stod(argv[2]) : 4.0;
+
+	PopulationStatistics<NN> statistics(range);
+	int generation = 0;
+	if(!checkpoint_statistics(filename, statistics, &generation)) return 1;
+
+	std::cout << filename << ": generation " << generation << ", " << statistics.size() << " networks" << std::endl;
+	print(std::cout, statistics);
+	return 0;
+}
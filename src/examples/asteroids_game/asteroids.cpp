@@ -19,7 +19,46 @@ using namespace asteroids;
 AsteroidsGame AsteroidsGame::current_game = AsteroidsGame(AsteroidsGeneticAlgorithm<NN>::gameOver);
 
 
+// asteroids --replay <file> [display] [ticks per second]
+int replay_main(int argc, char **argv) {
+	std::ifstream file(argv[2], std::ios::in | std::ios::binary);
+	ReplayLog log;
+	if(!read_from_file(file, log))
+	{
+		std::cout << "Could not read replay " << argv[2] << std::endl;
+		return 1;
+	}
+	
+	static ReplayPlayer player(log);
+	double ticks_per_second = (argc > 4) ? std::stod(argv[4]) : 0;
+	displayOn = (argc > 3) ? std::stoi(argv[3]) : false;
+	replayOn = true;
+	
+	if(!displayOn)
+	{
+		replay_loop(&player, ticks_per_second);
+		return player.verify() ? 0 : 1;
+	}
+	
+	glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
+    glutInitWindowPosition(100, 100);
+    glutInitWindowSize(X_WINDOW_SIZE, Y_WINDOW_SIZE);
+    glutCreateWindow("Asteroid AI Replay");
+    init();
+    
+    glutDisplayFunc(display);
+    simulation_thread = std::thread(replay_loop, &player, (ticks_per_second > 0) ? ticks_per_second : 60);
+    refresh_func(0);
+    glutKeyboardFunc(keyboard);
+    
+	glutMainLoop();
+	return 0;
+}
+
 int main(int argc, char **argv) {
+	if (argc > 2 && std::string(argv[1]) == "--replay") return replay_main(argc, argv);
+	
 	glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
     glutInitWindowPosition(100, 100);
@@ -28,6 +67,7 @@ int main(int argc, char **argv) {
     init();
 
 	neural::GaussianInitializer gauss(0, 1);
+	AsteroidsGeneticAlgorithm<NN>::genetic_algorithm.number_of_threads = std::max(1u, std::thread::hardware_concurrency());
 	
 	if (argc > 1) {
 		std::ifstream file(argv[1], std::ios::out | std::ios::in);
@@ -37,8 +77,9 @@ int main(int argc, char **argv) {
 			std::string generation;
 			getline(file, generation); 
 			AsteroidsGeneticAlgorithm<NN>::generation = std::stoi(generation);
-			AsteroidsGame::current_game.gen = std::default_random_engine(AsteroidsGeneticAlgorithm<NN>::generation);
+			AsteroidsGame::current_game.reseed(AsteroidsGeneticAlgorithm<NN>::generation);
 			read_from_file(file, AsteroidsGeneticAlgorithm<NN>::genetic_algorithm);
+			AsteroidsGeneticAlgorithm<NN>::genetic_algorithm.generation = AsteroidsGeneticAlgorithm<NN>::generation;
 			file.close();
 		}
 	}
@@ -50,9 +91,41 @@ int main(int argc, char **argv) {
 		displayOn = std::stoi(argv[2]);
 	}
 	
+	if (argc > 3) {
+		recordReplays = std::stoi(argv[3]);
+	}
+	
+	if (argc > 4) {
+		neural::trace_start(argv[4]);
+	}
+	
+	if (argc > 5) {
+		noveltySearch = std::stoi(argv[5]);
+	}
+	
+	if (argc > 6) {
+		steadyState = std::stoi(argv[6]);
+	}
+	
+	if (argc > 7) {
+		racing = std::stoi(argv[7]);
+	}
+	
+	if (argc > 8) {
+		screening = std::stod(argv[8]);
+	}
+	
+	if(steadyState) AsteroidsGeneticAlgorithm<NN>::start_steady_state();
+	else if(racing) AsteroidsGeneticAlgorithm<NN>::start_race();
+	else AsteroidsGeneticAlgorithm<NN>::AI.set_network(*AsteroidsGeneticAlgorithm<NN>::genetic_algorithm.population[0].first);
 	AsteroidsGame::current_game.addInitialParticle();
+	if(recordReplays) AsteroidsGeneticAlgorithm<NN>::recorder.begin(AsteroidsGame::current_game.seed, AsteroidsGeneticAlgorithm<NN>::generation, 0);
     glutDisplayFunc(display);
-    timer_func<NN>(30);
+    simulation_thread = std::thread([]() {
+    	neural::trace_thread_name("simulation");
+    	simulation_loop<NN>();
+    });
+    if(displayOn) refresh_func(0);
     //add_particle_func(50); 
 	
 	   
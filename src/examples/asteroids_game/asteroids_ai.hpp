@@ -10,18 +10,32 @@
 #define ASTEROIDS_AI_HPP_
 
 #include "asteroids_game.hpp"
+#include "asteroids_replay.hpp"
 #include "src/network/initialization.hpp"
 #include "src/network/math_functions.hpp"
 #include "src/network/perceptron_layer.hpp"
 #include "src/network/recurrent_layer.hpp"
 #include "src/network/genetic_algorithm_neural_network.hpp"
+#include "src/network/population_statistics.hpp"
+#include "src/network/novelty_archive.hpp"
+#include "src/network/steady_state_genetic_algorithm.hpp"
+#include "src/network/racing.hpp"
+#include "src/network/surrogate.hpp"
+#include "src/network/profiler.hpp"
+#include "src/network/trace.hpp"
+
+#include <thread>
+#include <memory>
 
 namespace asteroids
 {
 
 int N_evolve = 50; // How many of the top scorers to use when creating next generation.
 static constexpr int number_of_inputs = 16; // Inputs to neural network.
-static constexpr int recurrent_inputs = 0;
+bool noveltySearch = false; // Select parents on novelty of behavior rather than score.
+bool steadyState = false; // Replace one network after every episode instead of evolving whole generations.
+bool racing = false; // Score networks on several episodes, more of them near the selection cutoff.
+double screening = 1; // Fraction of the children that play, the ones the surrogate model predicts best.
 
 // Scorer class
 
@@ -35,15 +49,33 @@ struct AsteroidScorer {
 		return a > b;
 	}
 	
-	OutputType operator()(InputType& input) {
+	OutputType operator()(const InputType& input) {
 		return 0;
 	}
 };
 
 // Neural Network Class.
+// make GENOMES=float or GENOMES=bf16 keeps the population in float or in bfloat16 weights.
+// make MEMORY=elman or MEMORY=gru makes the hidden layer recurrent, so agents remember earlier ticks.
 
-using RL = neural::SigmoidLayer<number_of_inputs+recurrent_inputs,30>;
-using SL = neural::TanhLayer<30,2>;
+#if defined(ASTEROIDS_BF16_GENOMES)
+using Scalar = float;
+using Storage = Eigen::bfloat16;
+#elif defined(ASTEROIDS_FLOAT_GENOMES)
+using Scalar = float;
+using Storage = float;
+#else
+using Scalar = double;
+using Storage = double;
+#endif
+#if defined(ASTEROIDS_GRU)
+using RL = neural::GRULayer<Scalar, number_of_inputs, 30, Storage>;
+#elif defined(ASTEROIDS_ELMAN)
+using RL = neural::ElmanLayer<Scalar, number_of_inputs, 30, neural::sigmoid, Storage>;
+#else
+using RL = neural::PerceptronLayer<Scalar, number_of_inputs, 30, neural::sigmoid, Storage>;
+#endif
+using SL = neural::PerceptronLayer<Scalar, 30, 2, neural::tanh, Storage>;
 using NN = neural::NeuralNetwork<RL, SL>;
 
 neural::GaussianInitializer gauss(0, 1);
@@ -52,20 +84,36 @@ neural::GeneticAlgorithm<AsteroidScorer<NN>, NN> GenAlg(1000);
 template <typename NetworkType>
 struct AsteroidsGameAI {
 
-	AsteroidsGameAI(NetworkType& nn_) { network = nn_; }
-	void set_network(NetworkType& nn_) { network = nn_; }
+	// The AI reads the weights where they are, in a genome or a network of the caller, which must outlive the episode.
+	// Every episode starts with set_network, which also clears the memory of a recurrent network.
+	AsteroidsGameAI(const NetworkType& nn_) : network{&nn_} {}
+	void set_network(const NetworkType& nn_) {
+		network = &nn_;
+		memory = NetworkType::initial_state();
+	}
+
+	NetworkType::OutputType output(const typename NetworkType::InputType& state) {
+		return network->step(state, memory);
+	}
 
 	NetworkType::OutputType output() {
-		return network.feed_forward(AsteroidsGame::current_game.state());
+		return output(AsteroidsGame::current_game.state());
 	}
 
-	void action() {
-		auto out = output();
-		AsteroidsGame::current_game.play.velocity += out(0)*AsteroidsGame::current_game.play.orientation;
-		AsteroidsGame::current_game.play.orientation = Eigen::Rotation2D(out(1)/3)*AsteroidsGame::current_game.play.orientation;
+	// Act on an already computed state, so callers that also need the sensor readings only compute them once.
+	// Returns the quantized action that was applied, for replay recording.
+	ReplayAction action(const typename NetworkType::InputType& state) {
+		ReplayAction res = ReplayAction::quantize(output(state));
+		res.apply(AsteroidsGame::current_game.play);
+		return res;
 	}
 
-	NetworkType network;
+	ReplayAction action() {
+		return action(AsteroidsGame::current_game.state());
+	}
+
+	const NetworkType* network;
+	typename NetworkType::StateType memory = NetworkType::initial_state();
 };
 
 template <typename NetworkType>
@@ -79,9 +127,61 @@ struct AsteroidsGeneticAlgorithm {
 
 	static void gameOver();
 
+	// Steady-state mode: the next episode plays the next network of the queue.
+	using SteadyStateType = neural::SteadyStateGA<AsteroidScorer<NetworkType>, NetworkType>;
+
+	static void start_steady_state()
+	{
+		steady = std::make_unique<SteadyStateType>(genetic_algorithm, rate);
+		steady->next(task);
+		AI.set_network(*task.network);
+	}
+
+	static void steadyStateGameOver();
+
+	// Racing mode: a generation is a race, and the next episode is its next trial.
+	static void start_race()
+	{
+		race = std::make_unique<neural::Race>(genetic_algorithm.population_size, N_evolve, 4, 20, generation * 20);
+		race->next(trial);
+		AI.set_network(*genetic_algorithm.population[trial.individual].first);
+		AsteroidsGame::current_game.reseed(trial.seed);
+	}
+
+	// Behavior descriptor of the running episode: where the player ended up and where it
+	// spent its time on average, both scaled to [-1, 1].
+	using BehaviorType = neural::NoveltyArchive<4>::BehaviorType;
+
+	static void observe()
+	{
+		position_sum += AsteroidsGame::current_game.play.position;
+		++ticks;
+	}
+
+	static BehaviorType behavior()
+	{
+		const Eigen::Vector2d scale {2.0/X_WINDOW_SIZE, 2.0/Y_WINDOW_SIZE};
+		Eigen::Vector2d last = AsteroidsGame::current_game.play.position.cwiseProduct(scale);
+		Eigen::Vector2d mean = (ticks ? Eigen::Vector2d(position_sum/ticks) : Eigen::Vector2d::Zero()).cwiseProduct(scale);
+		BehaviorType res;
+		res << last.cwiseMax(-1).cwiseMin(1), mean.cwiseMax(-1).cwiseMin(1);
+		return res;
+	}
+
 	static AsteroidsGameAI<NetworkType> AI;
 	static neural::GeneticAlgorithm<AsteroidScorer<NetworkType>, NetworkType> genetic_algorithm;
-	static int index;
+	static ReplayRecorder recorder;
+	static neural::ProfileReport profile_report;
+	static std::unique_ptr<SteadyStateType> steady;
+	static typename SteadyStateType::Task task;
+	static std::unique_ptr<neural::Race> race;
+	static neural::Race::Trial trial;
+	static neural::Surrogate<NetworkType> surrogate;
+	static neural::NoveltyArchive<4> archive;
+	static std::vector<BehaviorType> behaviors;
+	static Eigen::Vector2d position_sum;
+	static int ticks;
+	static size_t index;
 	static int generation;
 	static double rate;
 };
@@ -94,43 +194,166 @@ template <typename NetworkType>
 double AsteroidsGeneticAlgorithm<NetworkType>::rate {0.05};
 
 template <typename NetworkType>
-int AsteroidsGeneticAlgorithm<NetworkType>::index {0};
+neural::ProfileReport AsteroidsGeneticAlgorithm<NetworkType>::profile_report {1};
+
+template <typename NetworkType>
+std::unique_ptr<typename AsteroidsGeneticAlgorithm<NetworkType>::SteadyStateType> AsteroidsGeneticAlgorithm<NetworkType>::steady;
+
+template <typename NetworkType>
+typename AsteroidsGeneticAlgorithm<NetworkType>::SteadyStateType::Task AsteroidsGeneticAlgorithm<NetworkType>::task;
+
+template <typename NetworkType>
+std::unique_ptr<neural::Race> AsteroidsGeneticAlgorithm<NetworkType>::race;
+
+template <typename NetworkType>
+neural::Race::Trial AsteroidsGeneticAlgorithm<NetworkType>::trial;
+
+template <typename NetworkType>
+neural::Surrogate<NetworkType> AsteroidsGeneticAlgorithm<NetworkType>::surrogate;
+
+template <typename NetworkType>
+neural::NoveltyArchive<4> AsteroidsGeneticAlgorithm<NetworkType>::archive {15, 0.05};
+
+template <typename NetworkType>
+std::vector<typename AsteroidsGeneticAlgorithm<NetworkType>::BehaviorType> AsteroidsGeneticAlgorithm<NetworkType>::behaviors;
+
+template <typename NetworkType>
+Eigen::Vector2d AsteroidsGeneticAlgorithm<NetworkType>::position_sum {0, 0};
+
+template <typename NetworkType>
+int AsteroidsGeneticAlgorithm<NetworkType>::ticks {0};
+
+template <typename NetworkType>
+size_t AsteroidsGeneticAlgorithm<NetworkType>::index {0};
 
 template <typename NetworkType>
 int AsteroidsGeneticAlgorithm<NetworkType>::generation {1};
 
 template <typename NetworkType>
-AsteroidsGameAI<NetworkType> AsteroidsGeneticAlgorithm<NetworkType>::AI {AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[0].first};
+ReplayRecorder AsteroidsGeneticAlgorithm<NetworkType>::recorder;
+
+template <typename NetworkType>
+AsteroidsGameAI<NetworkType> AsteroidsGeneticAlgorithm<NetworkType>::AI {*AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[0].first};
 
 template <typename NetworkType>
 void AsteroidsGeneticAlgorithm<NetworkType>::gameOver() {
+	if(steadyState) return steadyStateGameOver();
 	std::cout << "\r\t\t\t\r"
 		<< AsteroidsGeneticAlgorithm<NetworkType>::index 
 		<< " : " 
 		<< AsteroidsGame::current_game.max_score
 		<< std::flush;
-	AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[index].second = AsteroidsGame::current_game.score;
-	AsteroidsGeneticAlgorithm<NetworkType>::AI.network = AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[index].first;
+	// While racing, index counts episodes and the race says which network played.
+	size_t individual = racing ? AsteroidsGeneticAlgorithm<NetworkType>::trial.individual : AsteroidsGeneticAlgorithm<NetworkType>::index;
+	if(racing) AsteroidsGeneticAlgorithm<NetworkType>::race->report(AsteroidsGeneticAlgorithm<NetworkType>::trial, AsteroidsGame::current_game.score);
+	else AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[individual].second = AsteroidsGame::current_game.score;
+	// Sized here, the order in which the static members are initialized is not specified.
+	AsteroidsGeneticAlgorithm<NetworkType>::behaviors.resize(AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population_size);
+	AsteroidsGeneticAlgorithm<NetworkType>::behaviors[individual] = AsteroidsGeneticAlgorithm<NetworkType>::behavior();
+	AsteroidsGeneticAlgorithm<NetworkType>::position_sum.setZero();
+	AsteroidsGeneticAlgorithm<NetworkType>::ticks = 0;
+	if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.finish(AsteroidsGame::current_game.score);
 	AsteroidsGame::current_game.reset();
 	AsteroidsGeneticAlgorithm<NetworkType>::index++;
-	if(AsteroidsGeneticAlgorithm<NetworkType>::index == AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population.size()) {
-		AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve(N_evolve, AsteroidsGeneticAlgorithm<NetworkType>::rate);
+	// Screened out children do not play.
+	if(!racing)
+		while(AsteroidsGeneticAlgorithm<NetworkType>::index < AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population.size()
+			  && AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.is_screened_out(AsteroidsGeneticAlgorithm<NetworkType>::index))
+			AsteroidsGeneticAlgorithm<NetworkType>::index++;
+	bool generation_done = racing ? AsteroidsGeneticAlgorithm<NetworkType>::race->is_finished()
+		: AsteroidsGeneticAlgorithm<NetworkType>::index == AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population.size();
+	if(generation_done) {
+		std::vector<double> means;
+		if(racing)
+		{
+			means = AsteroidsGeneticAlgorithm<NetworkType>::race->means();
+			for(size_t i = 0; i < means.size(); ++i) AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[i].second = neural::to_score<typename AsteroidScorer<NetworkType>::OutputType>(means[i]);
+			std::cout << "\nRace: " << AsteroidsGeneticAlgorithm<NetworkType>::race->get_episodes_used() << " episodes";
+		}
+		{
+			neural::ProfileScope scope(neural::ProfilePhase::Telemetry);
+			neural::TraceSpan span("statistics", "io");
+			if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.save_best("replay-" + std::to_string(AsteroidsGeneticAlgorithm<NetworkType>::generation) + ".bin");
+			// Networks the surrogate screened out did not play.
+			auto statistics = neural::population_statistics(AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.scored_population(), std::max(1u, std::thread::hardware_concurrency()));
+			std::cout << "\n";
+			print(std::cout, statistics);
+		}
+		if(noveltySearch)
+		{
+			AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve_by_novelty(AsteroidsGeneticAlgorithm<NetworkType>::archive, AsteroidsGeneticAlgorithm<NetworkType>::behaviors, N_evolve, AsteroidsGeneticAlgorithm<NetworkType>::rate);
+			std::cout << "Novelty archive: " << AsteroidsGeneticAlgorithm<NetworkType>::archive.size()
+				<< " behaviors, threshold " << AsteroidsGeneticAlgorithm<NetworkType>::archive.threshold << std::endl;
+		}
+		else if(racing) AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve(N_evolve, AsteroidsGeneticAlgorithm<NetworkType>::rate, means);
+		else if(screening < 1)
+		{
+			size_t playing = AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve_screened(AsteroidsGeneticAlgorithm<NetworkType>::surrogate, N_evolve, AsteroidsGeneticAlgorithm<NetworkType>::rate, screening);
+			std::cout << "Surrogate: " << playing << " networks play." << std::endl;
+		}
+		else AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve(N_evolve, AsteroidsGeneticAlgorithm<NetworkType>::rate);
+		AsteroidsGeneticAlgorithm<NetworkType>::profile_report.generation_done(AsteroidsGeneticAlgorithm<NetworkType>::generation);
 		AsteroidsGeneticAlgorithm<NetworkType>::index = 0;
 		AsteroidsGeneticAlgorithm<NetworkType>::generation++;
 		std::cout << "\n" << AsteroidsGeneticAlgorithm<NetworkType>::generation << std::endl;
 		AsteroidsGame::current_game.max_score = 0;
+		if(racing)
+		{
+			AsteroidsGeneticAlgorithm<NetworkType>::start_race();
+			individual = AsteroidsGeneticAlgorithm<NetworkType>::trial.individual;
+		}
 	}
-	AsteroidsGame::current_game.gen = std::default_random_engine(AsteroidsGeneticAlgorithm<NetworkType>::generation);
+	else if(racing)
+	{
+		AsteroidsGeneticAlgorithm<NetworkType>::race->next(AsteroidsGeneticAlgorithm<NetworkType>::trial);
+		individual = AsteroidsGeneticAlgorithm<NetworkType>::trial.individual;
+	}
+	if(!racing) individual = AsteroidsGeneticAlgorithm<NetworkType>::index;
+	// Load the network after index and the population have been advanced, so the score of an episode is credited to the genome that played it.
+	AsteroidsGeneticAlgorithm<NetworkType>::AI.set_network(*AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population[individual].first);
+	AsteroidsGame::current_game.reseed(racing ? AsteroidsGeneticAlgorithm<NetworkType>::trial.seed : AsteroidsGeneticAlgorithm<NetworkType>::generation);
 	AsteroidsGame::current_game.addInitialParticle();
+	if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.begin(AsteroidsGame::current_game.seed, AsteroidsGeneticAlgorithm<NetworkType>::generation, individual);
 }
 
 
 
 
+// Every episode puts its network in the pool and plays the next child. index only counts
+// episodes, and every population size of them counts as a generation for the statistics.
+template <typename NetworkType>
+void AsteroidsGeneticAlgorithm<NetworkType>::steadyStateGameOver() {
+	std::cout << "\r\t\t\t\r"
+		<< AsteroidsGeneticAlgorithm<NetworkType>::index 
+		<< " : " 
+		<< AsteroidsGame::current_game.max_score
+		<< std::flush;
+	AsteroidsGeneticAlgorithm<NetworkType>::steady->report(AsteroidsGeneticAlgorithm<NetworkType>::task, AsteroidsGame::current_game.score);
+	if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.finish(AsteroidsGame::current_game.score);
+	AsteroidsGame::current_game.reset();
+	AsteroidsGeneticAlgorithm<NetworkType>::index++;
+	if(AsteroidsGeneticAlgorithm<NetworkType>::index == AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population.size()) {
+		{
+			neural::ProfileScope scope(neural::ProfilePhase::Telemetry);
+			neural::TraceSpan span("statistics", "io");
+			if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.save_best("replay-" + std::to_string(AsteroidsGeneticAlgorithm<NetworkType>::generation) + ".bin");
+			auto statistics = neural::population_statistics(AsteroidsGeneticAlgorithm<NetworkType>::genetic_algorithm.population, std::max(1u, std::thread::hardware_concurrency()));
+			std::cout << "\n";
+			print(std::cout, statistics);
+		}
+		AsteroidsGeneticAlgorithm<NetworkType>::profile_report.generation_done(AsteroidsGeneticAlgorithm<NetworkType>::generation);
+		AsteroidsGeneticAlgorithm<NetworkType>::index = 0;
+		AsteroidsGeneticAlgorithm<NetworkType>::generation++;
+		std::cout << "\n" << AsteroidsGeneticAlgorithm<NetworkType>::generation << std::endl;
+		AsteroidsGame::current_game.max_score = 0;
+	}
+	AsteroidsGeneticAlgorithm<NetworkType>::steady->next(AsteroidsGeneticAlgorithm<NetworkType>::task);
+	AsteroidsGeneticAlgorithm<NetworkType>::AI.set_network(*AsteroidsGeneticAlgorithm<NetworkType>::task.network);
+	AsteroidsGame::current_game.reseed(AsteroidsGeneticAlgorithm<NetworkType>::generation);
+	AsteroidsGame::current_game.addInitialParticle();
+	if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.begin(AsteroidsGame::current_game.seed, AsteroidsGeneticAlgorithm<NetworkType>::generation, index);
+}
 
-using RL = neural::SigmoidLayer<16,30>;
-using SL = neural::TanhLayer<30,2>;
-using NN = neural::NeuralNetwork<RL, SL>;
 
 }
 #endif /* ASTEROIDS_AI_HPP_ */
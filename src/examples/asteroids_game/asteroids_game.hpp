@@ -198,15 +198,15 @@ struct AsteroidsGame
 		for(int i = 0; i < number_of_angles; ++i)
 		{
 			double beta = -PI + (double)i*2*PI/number_of_angles;
-			res(i) = -distance_to_boundary(current_game.play.position, current_game.play.orientation, beta);
-			res(i+number_of_angles) = -0.5*(Eigen::Rotation2D(beta)*current_game.play.orientation).transpose() * current_game.play.velocity;
+			res(i) = -distance_to_boundary(play.position, play.orientation, beta);
+			res(i+number_of_angles) = -0.5*(Eigen::Rotation2D(beta)*play.orientation).transpose() * play.velocity;
 		}
 		
-		for (int i = 0; i < current_game.number_of_particles; ++i)
+		for (int i = 0; i < number_of_particles; ++i)
 		{
-			const auto& p = current_game.particles[i];
-			Eigen::Vector2d d = p.position - current_game.play.position;
-			double theta = angle(current_game.play.orientation, d);
+			const auto& p = particles[i];
+			Eigen::Vector2d d = p.position - play.position;
+			double theta = angle(play.orientation, d);
 			
 			for(int i = 0; i < number_of_angles; ++i)
 			{
@@ -221,7 +221,7 @@ struct AsteroidsGame
 					if (-distance_to_surface > res(i))
 					{
 						res(i) = -distance_to_surface;
-						res(i+number_of_angles) = (d.transpose()/d.norm())*(p.velocity - current_game.play.velocity);
+						res(i+number_of_angles) = (d.transpose()/d.norm())*(p.velocity - play.velocity);
 					}
 				}
 			}
@@ -261,6 +261,12 @@ struct AsteroidsGame
 			particles[number_of_particles++] = (Particle(pos_, vel_, radius));
 	}
 	
+	// Episodes are fully determined by the seed and the actions taken, so keep track of it for replays.
+	void reseed(unsigned int seed_) {
+		seed = seed_;
+		gen = std::default_random_engine(seed);
+	}
+	
 	void addInitialParticle() {
 		double ang = PI*dist(gen);
 		Eigen::Vector2d pos_ {300*cos(ang), 300*sin(ang)};
@@ -276,6 +282,7 @@ struct AsteroidsGame
 	//Game Objects.
 	std::array<Particle, 200> particles;
 	std::default_random_engine gen;
+	unsigned int seed = std::default_random_engine::default_seed;
 	std::uniform_real_distribution<double> dist;
 	Player play;
 	int score;
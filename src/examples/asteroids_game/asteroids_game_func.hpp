@@ -6,7 +6,11 @@
 //  Copyright © 2020 Reid Harris. All rights reserved.
 //
 
+#include <atomic>
+#include <thread>
+
 #include "asteroids_ai.hpp"
+#include "triple_buffer.hpp"
 
 #ifndef ASTEROIDS_GAME_FUNC_HPP_
 #define ASTEROIDS_GAME_FUNC_HPP_
@@ -16,6 +20,42 @@ namespace asteroids
 bool loadFromFile = true;
 bool displayOn = true;
 
+/*
+ *  Frame snapshots.
+ *
+ *  The simulation runs on its own thread and publishes a copy of everything the
+ *  renderer needs after every tick. The GLUT display callback draws whichever frame
+ *  is the latest, so rendering never stalls the trainer.
+ */
+
+struct FrameSnapshot {
+	std::array<AsteroidsGame::Particle, 200> particles;
+	int number_of_particles = 0;
+	AsteroidsGame::Player play;
+	std::array<double, 8> sensors {};
+	int score = 0;
+	int index = 0;
+	int generation = 0;
+};
+
+TripleBuffer<FrameSnapshot> frames;
+
+template <typename StateType>
+void publish_frame(const AsteroidsGame& game, const StateType& state, int index, int generation)
+{
+	FrameSnapshot& frame = frames.write_buffer();
+	
+	std::copy(game.particles.begin(), game.particles.begin()+game.number_of_particles, frame.particles.begin());
+	frame.number_of_particles = game.number_of_particles;
+	frame.play = game.play;
+	for(int i = 0; i < 8; ++i) frame.sensors[i] = state(i);
+	frame.score = game.score;
+	frame.index = index;
+	frame.generation = generation;
+	
+	frames.publish();
+}
+
 void init() {
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glMatrixMode(GL_PROJECTION);
@@ -28,14 +68,14 @@ void drawBitmapText(std::string s, float x, float y)
 	for(char c : s)  glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, c);
 }
 
-void drawLineFromShip(double distance, double theta) {
+void drawLineFromShip(AsteroidsGame::Player& play, double distance, double theta) {
 	Eigen::Vector2d e1 {1,0};
-	double orientation_angle = angle(AsteroidsGame::current_game.play.orientation, e1);
-	double x = AsteroidsGame::current_game.play.position(0) + distance*cos(theta - orientation_angle);
-	double y = AsteroidsGame::current_game.play.position(1) + distance*sin(theta - orientation_angle);
+	double orientation_angle = angle(play.orientation, e1);
+	double x = play.position(0) + distance*cos(theta - orientation_angle);
+	double y = play.position(1) + distance*sin(theta - orientation_angle);
 	
 	glBegin(GL_LINES);
-	glVertex2f(AsteroidsGame::current_game.play.position(0), AsteroidsGame::current_game.play.position(1));
+	glVertex2f(play.position(0), play.position(1));
 	glVertex2f(x, y);
 	glEnd();
 	
@@ -43,61 +83,101 @@ void drawLineFromShip(double distance, double theta) {
 
 void display()
 {
+	// The drawing helpers take mutable references, so draw from a local copy of the latest frame.
+	FrameSnapshot frame = frames.read();
+	
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	glColor3f(1,1,1);
 	
 	// Display stats.
-	drawBitmapText("Maximum Score: " 		+ std::to_string(AsteroidsGame::current_game.number_of_particles), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-94);
-	drawBitmapText("Score: " 				+ std::to_string(AsteroidsGame::current_game.score), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-70);
-	drawBitmapText("Agent Number: " 		+ std::to_string(AsteroidsGeneticAlgorithm<NN>::index), 		-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-46);
-	drawBitmapText("Generation: " 			+ std::to_string(AsteroidsGeneticAlgorithm<NN>::generation), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-22);
-	
-	for (int i = 0; i < AsteroidsGame::current_game.number_of_particles; ++i) 
-		AsteroidsGame::current_game.particles[i].draw(); //Show particles.
-	AsteroidsGame::current_game.play.draw(); //Show player.
-	
+	drawBitmapText("Maximum Score: " 		+ std::to_string(frame.number_of_particles), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-94);
+	drawBitmapText("Score: " 				+ std::to_string(frame.score), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-70);
+	drawBitmapText("Agent Number: " 		+ std::to_string(frame.index), 		-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-46);
+	drawBitmapText("Generation: " 			+ std::to_string(frame.generation), 	-X_WINDOW_SIZE/2+50, Y_WINDOW_SIZE/2-22);
 	
-	auto res = AsteroidsGame::current_game.state();
-	Eigen::Vector2d e1 {1,0};
+	for (int i = 0; i < frame.number_of_particles; ++i) 
+		frame.particles[i].draw(); //Show particles.
+	frame.play.draw(); //Show player.
 	
 	glColor3f(1.0f, 0, 0);
 	for(int i = 0; i < 8; ++i) {
-		drawLineFromShip(-res(i), -PI + (double)i*PI/4);
+		drawLineFromShip(frame.play, -frame.sensors[i], -PI + (double)i*PI/4);
 	}
 	glColor3f(0,0,1);
-	drawLineFromShip(100, 0);
+	drawLineFromShip(frame.play, 100, 0);
 	
 	
 	glFlush();
 	glutSwapBuffers();
 }
 
-bool escape = false;
+std::atomic<bool> escape {false};
+std::thread simulation_thread;
 
+// One simulation tick. n counts down the ticks until the next particle spawns.
 template <typename NetworkType>
-void timer_func(int n)
+void simulation_step(int& n)
 {
-	if(displayOn) display();
-	if(n==0) 
+	bool game_over = AsteroidsGame::current_game.game_over;
 	{
-		AsteroidsGame::current_game.addRandomParticle(50);
-		n = 30;
+		neural::ProfileScope scope(neural::ProfilePhase::Evaluation);
+		neural::TraceSpan span("step", "asteroids");
+		if(n==0) 
+		{
+			AsteroidsGame::current_game.addRandomParticle(50);
+			n = 30;
+		}
+		typename NetworkType::InputType state = AsteroidsGame::current_game.state().template cast<typename NetworkType::ScalarType>();
+		if(displayOn) publish_frame(AsteroidsGame::current_game, state, AsteroidsGeneticAlgorithm<NetworkType>::index, AsteroidsGeneticAlgorithm<NetworkType>::generation);
+		ReplayAction action = AsteroidsGeneticAlgorithm<NetworkType>::AI.action(state);
+		if(recordReplays) AsteroidsGeneticAlgorithm<NetworkType>::recorder.record(action);
+		if(!game_over)
+		{
+			AsteroidsGame::current_game.update();
+			if(noveltySearch) AsteroidsGeneticAlgorithm<NetworkType>::observe();
+			--n;
+		}
 	}
-	if(escape) return;
-	AsteroidsGeneticAlgorithm<NetworkType>::AI.action();
-	if(AsteroidsGame::current_game.game_over)
+	// Game over starts the next episode, and evolves the population at the end of a generation.
+	if(game_over)
 	{
 		AsteroidsGame::current_game.game_over_callable();
-		glutTimerFunc(3, timer_func<NetworkType>, 30);
-	}
-	else
-	{
-		AsteroidsGame::current_game.update();
-		glutTimerFunc(0,timer_func<NetworkType>, n-1);
+		n = 30;
 	}
 }
 
+template <typename NetworkType>
+void simulation_loop()
+{
+	int n = 30;
+	while(!escape) simulation_step<NetworkType>(n);
+}
+
+bool replayOn = false;
+
+// Re-simulates a recorded episode, publishing frames for the renderer when the display is on.
+void replay_loop(ReplayPlayer* player, double ticks_per_second)
+{
+	const ReplayLog& log = player->get_log();
+	player->play(ticks_per_second, [&log](ReplayPlayer& p)
+		{
+			if(displayOn) publish_frame(p.get_game(), p.get_game().state(), log.genome_id, log.generation);
+			return !escape;
+		});
+	std::cout << "Replay of genome " << log.genome_id << " (generation " << log.generation << "): "
+		<< player->get_game().score << " / " << log.score
+		<< (player->verify() ? " [ok]" : " [mismatch]") << std::endl;
+}
+
+// Redraw at roughly 60Hz, independently of the simulation rate.
+void refresh_func(int)
+{
+	if(escape) return;
+	glutPostRedisplay();
+	glutTimerFunc(16, refresh_func, 0);
+}
+
 void add_particle_func(int size)
 {  
 	if(escape) return;
@@ -109,6 +189,10 @@ void keyboard(unsigned char key, int x, int y)
 {
     switch (key) {
         case 27: //ESC.
+			escape = true;
+			if(simulation_thread.joinable()) simulation_thread.join();
+			neural::trace_stop();
+			if(replayOn) exit(0);
             std::ofstream file("parameters-v1.txt", std::ios::out | std::ios::trunc);
 			if(file.is_open())
 			{
@@ -116,7 +200,6 @@ void keyboard(unsigned char key, int x, int y)
 				save_to_file(file, AsteroidsGeneticAlgorithm<NN>::genetic_algorithm);
 			} 
 			file.close(); 
-			escape = true;
 			exit(0);
             break;
 	}
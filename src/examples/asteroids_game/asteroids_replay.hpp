@@ -0,0 +1,322 @@
+//
+//  asteroids_replay.hpp
+//  Asteroids
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+
+#ifndef ASTEROIDS_REPLAY_HPP_
+#define ASTEROIDS_REPLAY_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+#include "asteroids_game.hpp"
+
+namespace asteroids
+{
+
+bool recordReplays = false;
+
+/*
+ *  Replay Action
+ *
+ *  The network outputs (thrust, turn) in [-1, 1]. They are quantized to 16 bits before
+ *  being applied, both live and in replays, so that a recorded episode re-simulates
+ *  bit for bit from its seed and action stream.
+ */
+
+struct ReplayAction {
+	static constexpr double scale = 32767;
+
+	template <typename OutputType>
+	static ReplayAction quantize(const OutputType& out) {
+		auto q = [](double x) { return (int16_t)std::lround(std::clamp(x, -1.0, 1.0)*scale); };
+		return {q(out(0)), q(out(1))};
+	}
+
+	void apply(AsteroidsGame::Player& play) const {
+		play.velocity += (thrust/scale)*play.orientation;
+		play.orientation = Eigen::Rotation2D<double>(turn/scale/3)*play.orientation;
+	}
+
+	bool operator==(const ReplayAction&) const = default;
+
+	int16_t thrust;
+	int16_t turn;
+};
+
+/*
+ *  Replay Log
+ *
+ *  One episode: the seed, which genome played it and the run length encoded action
+ *  stream. At most 5 bytes per tick, and much less once the tanh outputs of a trained
+ *  agent start to saturate and repeat.
+ *
+ *  File layout (little endian):
+ *      "ASRP" version:u8 seed:u32 generation:u32 genome_id:u32 score:i32 ticks:u32 runs:u32
+ *      runs x { thrust:i16 turn:i16 length:varint }
+ */
+
+struct ReplayLog {
+	static constexpr char magic[4] = {'A', 'S', 'R', 'P'};
+	static constexpr uint8_t version = 1;
+
+	void push_back(ReplayAction action) {
+		if(!runs.empty() && runs.back().first == action) ++runs.back().second;
+		else runs.push_back({action, 1});
+		++number_of_ticks;
+	}
+
+	uint32_t seed = 0;
+	uint32_t generation = 0;
+	uint32_t genome_id = 0;
+	int32_t score = 0;
+	uint32_t number_of_ticks = 0;
+	std::vector<std::pair<ReplayAction, uint32_t>> runs;
+};
+
+namespace replay_detail
+{
+
+template <typename T>
+void write_le(std::ostream& out, T value) {
+	for(size_t i = 0; i < sizeof(T); ++i) out.put((char)(((uint64_t)value >> (8*i)) & 0xff));
+}
+
+template <typename T>
+bool read_le(std::istream& in, T& value) {
+	uint64_t res = 0;
+	for(size_t i = 0; i < sizeof(T); ++i) {
+		int c = in.get();
+		if(c == EOF) return false;
+		res |= (uint64_t)(uint8_t)c << (8*i);
+	}
+	value = (T)res;
+	return true;
+}
+
+inline void write_varint(std::ostream& out, uint32_t value) {
+	while(value >= 0x80) {
+		out.put((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.put((char)value);
+}
+
+inline bool read_varint(std::istream& in, uint32_t& value) {
+	value = 0;
+	for(int shift = 0; shift < 35; shift += 7) {
+		int c = in.get();
+		if(c == EOF) return false;
+		value |= (uint32_t)(c & 0x7f) << shift;
+		if(!(c & 0x80)) return true;
+	}
+	return false;
+}
+
+}
+
+inline void save_to_file(std::ofstream& file, const ReplayLog& log)
+{
+	using namespace replay_detail;
+	if(!file.is_open()) return;
+	file.write(ReplayLog::magic, 4);
+	write_le(file, ReplayLog::version);
+	write_le(file, log.seed);
+	write_le(file, log.generation);
+	write_le(file, log.genome_id);
+	write_le(file, log.score);
+	write_le(file, log.number_of_ticks);
+	write_le(file, (uint32_t)log.runs.size());
+	for(const auto& [action, length] : log.runs) {
+		write_le(file, action.thrust);
+		write_le(file, action.turn);
+		write_varint(file, length);
+	}
+}
+
+// Returns false if the file is not a valid replay.
+inline bool read_from_file(std::ifstream& file, ReplayLog& log)
+{
+	using namespace replay_detail;
+	if(!file.is_open()) return false;
+	char header[4];
+	uint8_t version;
+	uint32_t number_of_runs, total = 0;
+	if(!file.read(header, 4) || !std::equal(header, header+4, ReplayLog::magic)) return false;
+	if(!read_le(file, version) || version != ReplayLog::version) return false;
+	if(!(read_le(file, log.seed) && read_le(file, log.generation) && read_le(file, log.genome_id)
+		&& read_le(file, log.score) && read_le(file, log.number_of_ticks) && read_le(file, number_of_runs))) return false;
+
+	log.runs.resize(number_of_runs);
+	for(auto& [action, length] : log.runs) {
+		if(!(read_le(file, action.thrust) && read_le(file, action.turn) && read_varint(file, length))) return false;
+		total += length;
+	}
+	return total == log.number_of_ticks;
+}
+
+/*
+ *  Replay Recorder
+ *
+ *  Captures every episode while training and keeps the best one of the generation.
+ */
+
+class ReplayRecorder
+{
+public :
+	void begin(uint32_t seed, uint32_t generation, uint32_t genome_id) {
+		current = ReplayLog();
+		current.seed = seed;
+		current.generation = generation;
+		current.genome_id = genome_id;
+	}
+
+	void record(ReplayAction action) { current.push_back(action); }
+
+	void finish(int score) {
+		current.score = score;
+		if(!has_best || score > best.score) {
+			best = std::move(current);
+			has_best = true;
+		}
+	}
+
+	// Writes the best episode recorded since the last call.
+	void save_best(const std::string& filename) {
+		if(!has_best) return;
+		std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		save_to_file(file, best);
+		has_best = false;
+	}
+
+private :
+	ReplayLog current;
+	ReplayLog best;
+	bool has_best = false;
+};
+
+/*
+ *  Replay Player
+ *
+ *  Re-simulates a log on its own AsteroidsGame, headless or with a per tick callback for
+ *  rendering. A copy of the game is kept every snapshot_interval ticks so that seeking
+ *  only has to simulate forward from the nearest earlier snapshot.
+ */
+
+class ReplayPlayer
+{
+public :
+	static constexpr uint32_t snapshot_interval = 256;
+
+	ReplayPlayer(ReplayLog log_)
+		: log{std::move(log_)}
+	{
+		restart();
+	}
+
+	// Advance one tick. Returns false once the episode is over.
+	bool step() {
+		if(finished()) return false;
+		if(tick == snapshots.size()*snapshot_interval) snapshots.push_back({tick, run, offset, n, game});
+
+		// Same ordering as simulation_step in asteroids_game_func.hpp.
+		if(n == 0)
+		{
+			game.addRandomParticle(50);
+			n = 30;
+		}
+		log.runs[run].first.apply(game.play);
+		if(++offset == log.runs[run].second)
+		{
+			++run;
+			offset = 0;
+		}
+		if(!game.game_over)
+		{
+			game.update();
+			--n;
+		}
+		++tick;
+		return true;
+	}
+
+	void seek(uint32_t target) {
+		target = std::min(target, log.number_of_ticks);
+		if(!snapshots.empty())
+		{
+			const Snapshot& s = snapshots[std::min<size_t>(target/snapshot_interval, snapshots.size()-1)];
+			if(target < tick || s.tick > tick) restore(s);
+		}
+		while(tick < target) step();
+	}
+
+	// Plays to the end at the given rate, or as fast as possible if ticks_per_second <= 0.
+	// Stops early if on_tick returns false.
+	void play(double ticks_per_second, std::function<bool(ReplayPlayer&)> on_tick = {}) {
+		auto start = std::chrono::steady_clock::now();
+		uint32_t first = tick;
+		while(step()) {
+			if(on_tick && !on_tick(*this)) return;
+			if(ticks_per_second > 0)
+				std::this_thread::sleep_until(start + std::chrono::duration<double>((tick-first)/ticks_per_second));
+		}
+	}
+
+	// True if the re-simulated episode ended where and how the recording did.
+	bool verify() const { return finished() && game.game_over && game.score == log.score; }
+
+	bool finished() const { return tick >= log.number_of_ticks; }
+	uint32_t current_tick() const { return tick; }
+	AsteroidsGame& get_game() { return game; }
+	const ReplayLog& get_log() const { return log; }
+
+private :
+	struct Snapshot {
+		uint32_t tick;
+		size_t run;
+		uint32_t offset;
+		int n;
+		AsteroidsGame game;
+	};
+
+	void restart() {
+		game = AsteroidsGame();
+		game.reseed(log.seed);
+		game.addInitialParticle();
+		tick = 0;
+		run = 0;
+		offset = 0;
+		n = 30;
+		snapshots.clear();
+	}
+
+	void restore(const Snapshot& s) {
+		tick = s.tick;
+		run = s.run;
+		offset = s.offset;
+		n = s.n;
+		game = s.game;
+	}
+
+	ReplayLog log;
+	AsteroidsGame game;
+	uint32_t tick;
+	size_t run;
+	uint32_t offset;
+	int n;
+	std::vector<Snapshot> snapshots;
+};
+
+}
+
+#endif /* ASTEROIDS_REPLAY_HPP_ */
@@ -0,0 +1,62 @@
+//
+//  triple_buffer.hpp
+//  Asteroids
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+
+#ifndef ASTEROIDS_TRIPLE_BUFFER_HPP_
+#define ASTEROIDS_TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+
+namespace asteroids
+{
+
+/*
+ *  Single producer / single consumer triple buffer.
+ *
+ *  The writer fills write_buffer() and calls publish(); the reader calls read() and
+ *  always gets the most recently published value. Neither side ever blocks: the
+ *  writer and reader each own one slot and swap through the shared middle slot.
+ */
+
+template <typename T>
+class TripleBuffer
+{
+public :
+	TripleBuffer()
+		: front{0}
+		, middle{1}
+		, back{2}
+	{}
+
+	// Writer side.
+	T& write_buffer() { return buffers[back]; }
+
+	void publish() { back = middle.exchange(back | dirty_bit, std::memory_order_acq_rel) & index_mask; }
+
+	// Reader side.
+	bool has_update() const { return middle.load(std::memory_order_relaxed) & dirty_bit; }
+
+	const T& read()
+	{
+		if(has_update()) front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+		return buffers[front];
+	}
+
+private :
+	static constexpr int dirty_bit  = 4;
+	static constexpr int index_mask = 3;
+
+	std::array<T, 3> buffers;
+	int front;
+	std::atomic<int> middle;
+	int back;
+};
+
+}
+
+#endif /* ASTEROIDS_TRIPLE_BUFFER_HPP_ */
@@ -0,0 +1,82 @@
+//
+//  check.cpp
+//  Codegen
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Checks the code generated for a sample checkpoint against NeuralNetwork::feed_forward
+//  on the same checkpoint, and times both. Built and run by make check, which generates
+//  sample_policy.hpp first. Fails if any output differs by more than rounding.
+//
+//  usage: check checkpoint
+//
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/network/initialization.hpp"
+#include "sample_network.hpp"
+#include "sample_policy.hpp"
+
+using namespace neural;
+
+static_assert(sample_policy::input_size == SampleNetwork::InputSize && sample_policy::output_size == SampleNetwork::OutputSize);
+
+// Nanoseconds per call of f over every input, best of five runs.
+template <typename F>
+double time_per_input(const std::vector<SampleNetwork::InputType>& inputs, F f) {
+	double best = 1e300;
+	for(int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for(const auto& input : inputs) f(input);
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inputs.size());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		std::cout << "usage: check checkpoint" << std::endl;
+		return 1;
+	}
+	std::ifstream file(argv[1]);
+	std::string shape;
+	getline(file, shape);
+	SampleNetwork network;
+	read_from_file(file, network);
+
+	GaussianInitializer gauss(0, 1);
+	std::vector<SampleNetwork::InputType> inputs(10000);
+	for(size_t i = 0; i < inputs.size(); ++i) gauss.initialize(inputs[i], 1, i);
+
+	double difference = 0;
+	for(const auto& x : inputs)
+	{
+		SampleNetwork::OutputType generated;
+		sample_policy::feed_forward(x.data(), generated.data());
+		difference = std::max(difference, (generated - network.feed_forward(x)).cwiseAbs().maxCoeff());
+	}
+
+	double sink = 0;
+	double t_network = time_per_input(inputs, [&](const SampleNetwork::InputType& x) { sink += network.feed_forward(x)(0); });
+	double t_generated = time_per_input(inputs, [&](const SampleNetwork::InputType& x) {
+		SampleNetwork::OutputType y;
+		sample_policy::feed_forward(x.data(), y.data());
+		sink += y(0);
+	});
+
+	const double tolerance = 1e-12;
+	bool equivalent = difference <= tolerance;
+	std::cout << "NeuralNetwork : " << t_network << " ns" << std::endl;
+	std::cout << "generated     : " << t_generated << " ns" << (sink == 0.5 ? " " : "") << std::endl;
+	std::cout << "largest difference " << difference << ", " << (equivalent ? "equivalent" : "NOT equivalent") << std::endl;
+	return equivalent ? 0 : 1;
+}
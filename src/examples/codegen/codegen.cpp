@@ -0,0 +1,64 @@
+//
+//  codegen.cpp
+//  Codegen
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Writes a trained network as a standalone C++ header, see src/network/codegen.hpp.
+//  The checkpoint is one network with its shape header, as save_shape and save_to_file
+//  write it. --sample writes a random SampleNetwork checkpoint instead, for make check.
+//
+//  usage: codegen checkpoint name [header], the header defaulting to name.hpp
+//         codegen --sample checkpoint
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/initialization.hpp"
+#include "src/network/layer.hpp"
+#include "src/network/codegen.hpp"
+#include "sample_network.hpp"
+
+using namespace neural;
+
+int main(int argc, char** argv)
+{
+	if(argc > 2 && std::string(argv[1]) == "--sample")
+	{
+		SampleNetwork network;
+		GaussianInitializer gauss(0, 0.3);
+		network.initialize(gauss, 0);
+		std::ofstream file(argv[2]);
+		save_shape(file, network);
+		save_to_file(file, network);
+		return file.good() ? 0 : 1;
+	}
+	if(argc < 3)
+	{
+		std::cout << "usage: codegen checkpoint name [header]" << std::endl;
+		std::cout << "       codegen --sample checkpoint" << std::endl;
+		return 1;
+	}
+
+	DynamicNeuralNetwork<double> network;
+	std::ifstream checkpoint(argv[1]);
+	if(!read_from_file(checkpoint, network)) return 1;
+
+	std::string name = argv[2];
+	std::ostringstream code;
+	if(!generate_code(code, network, name)) return 1;
+	std::string path = argc > 3 ? argv[3] : name + ".hpp";
+	std::ofstream header(path);
+	if(!header.is_open())
+	{
+		std::cout << "Cannot write " << path << std::endl;
+		return 1;
+	}
+	header << code.str();
+	return header.good() ? 0 : 1;
+}
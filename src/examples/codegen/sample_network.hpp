@@ -0,0 +1,20 @@
+//
+//  sample_network.hpp
+//  Codegen
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  The network make check generates code for. The middle layer is larger than
+//  CodegenOptions::unroll_limit, so both ways of writing a layer are checked.
+//
+
+#ifndef SAMPLE_NETWORK_HPP_
+#define SAMPLE_NETWORK_HPP_
+
+#include "src/network/math_functions.hpp"
+#include "src/network/plain_neural_network.hpp"
+
+using SampleNetwork = neural::NeuralNetwork<neural::ReLULayer<16, 128>, neural::SigmoidLayer<128, 64>, neural::TanhLayer<64, 2>>;
+
+#endif /* SAMPLE_NETWORK_HPP_ */
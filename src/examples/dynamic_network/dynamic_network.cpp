@@ -0,0 +1,114 @@
+//
+//  dynamic_network.cpp
+//  Dynamic Network
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Saves a fixed network with its shape in the checkpoint header, reads it back as a
+//  DynamicNeuralNetwork and compares the two, then times a runtime network of the shape
+//  given on the command line against the same shape with every size one off, which no
+//  specialized kernel covers.
+//
+//  usage: dynamic_network [sizes...], the sizes of every layer from inputs to outputs
+//
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/plain_neural_network.hpp"
+#include "src/network/initialization.hpp"
+#include "src/network/layer.hpp"
+
+using namespace neural;
+
+using NN  = NeuralNetwork<SigmoidLayer<16, 30>, TanhLayer<30, 2>>;
+using DNN = DynamicNeuralNetwork<double>;
+
+// Nanoseconds per call of f over every input, best of five runs.
+template <typename InputT, typename F>
+double time_per_input(const std::vector<InputT>& inputs, F f) {
+	double best = 1e300;
+	for(int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for(const auto& input : inputs) f(input);
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inputs.size());
+	}
+	return best;
+}
+
+DNN random_network(const std::vector<int>& sizes, GaussianInitializer& gauss)
+{
+	DNN res;
+	for(size_t l = 0; l + 1 < sizes.size(); ++l)
+		res.add_layer(sizes[l], sizes[l+1], l + 2 == sizes.size() ? ActivationType::Tanh : ActivationType::ReLU);
+	res.initialize(gauss);
+	return res;
+}
+
+// Time per forward pass of a random network of the given sizes.
+void time_shape(const std::vector<int>& sizes, int number_of_inputs)
+{
+	GaussianInitializer gauss(0, 1);
+	DNN network = random_network(sizes, gauss);
+	std::vector<DNN::VectorType> inputs(number_of_inputs, DNN::VectorType(sizes.front()));
+	for(size_t i = 0; i < inputs.size(); ++i) gauss.initialize(inputs[i], 1, i);
+
+	DNN::VectorType output;
+	double sink = 0;
+	double t = time_per_input(inputs, [&](const DNN::VectorType& x) { network.feed_forward(x, output); sink += output(0); });
+
+	int specialized = 0;
+	for(const auto& layer : network.layers) specialized += layer.is_specialized();
+	for(int s : sizes) std::cout << s << " ";
+	std::cout << ": " << t << " ns, " << specialized << " of " << network.number_of_layers() << " layers specialized" << (sink == 0.5 ? " " : "") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> sizes;
+	for(int i = 1; i < argc; ++i) sizes.push_back(std::stoi(argv[i]));
+	if(sizes.size() < 2) sizes = {16, 30, 2};
+
+	// A fixed network through a checkpoint with a shape header.
+	NN network;
+	GaussianInitializer gauss(0, 1);
+	network.initialize(gauss, 0);
+	{
+		std::ofstream file("dynamic_network.txt");
+		save_shape(file, network);
+		save_to_file(file, network);
+	}
+	DNN loaded;
+	{
+		std::ifstream file("dynamic_network.txt");
+		if(!read_from_file(file, loaded)) return 1;
+	}
+
+	std::vector<NN::InputType> inputs(2000);
+	for(size_t i = 0; i < inputs.size(); ++i) gauss.initialize(inputs[i], 1, i);
+	double difference = 0;
+	for(const auto& x : inputs) difference = std::max(difference, (network.feed_forward(x) - loaded.feed_forward(DNN::VectorType(x))).cwiseAbs().maxCoeff());
+
+	std::vector<DNN::VectorType> dynamic_inputs(inputs.begin(), inputs.end());
+	DNN::VectorType output;
+	double sink = 0;
+	double t_fixed   = time_per_input(inputs, [&](const NN::InputType& x) { sink += network.feed_forward(x)(0); });
+	double t_dynamic = time_per_input(dynamic_inputs, [&](const DNN::VectorType& x) { loaded.feed_forward(x, output); sink += output(0); });
+
+	std::cout << "16 30 2 fixed   : " << t_fixed << " ns" << std::endl;
+	std::cout << "16 30 2 dynamic : " << t_dynamic << " ns, largest difference " << difference << (sink == 0.5 ? " " : "") << std::endl;
+
+	// The requested shape, and every size one more.
+	std::vector<int> odd = sizes;
+	for(int& s : odd) ++s;
+	time_shape(sizes, 2000);
+	time_shape(odd, 2000);
+	return 0;
+}
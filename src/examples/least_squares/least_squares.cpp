@@ -0,0 +1,101 @@
+//
+//  least_squares.cpp
+//  Least Squares
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Solves a known least squares problem with the normal equations, by Cholesky and by
+//  LDLT, streamed sample by sample and accumulated in blocks over threads, and with a
+//  ridge, against the same problem solved in long double. Then checks that recursive
+//  least squares converges to the batch solution and that a singular system is reported.
+//  Fails otherwise.
+//
+//  usage: least_squares [samples]
+//
+
+#include <iostream>
+#include <string>
+
+#include "src/linear_regression/least_squares.hpp"
+
+using namespace neural;
+
+static constexpr int number_of_inputs = 16;
+static constexpr int number_of_outputs = 4;
+
+using Equations = NormalEquations<double, number_of_inputs, number_of_outputs>;
+using Model = NormalEquationLinearModel<double, number_of_inputs, number_of_outputs>;
+using RLSModel = RecursiveLeastSquaresLinearModel<double, number_of_inputs, number_of_outputs>;
+using InputsType = Eigen::Matrix<double, number_of_inputs, Eigen::Dynamic>;
+using OutputsType = Eigen::Matrix<double, number_of_outputs, Eigen::Dynamic>;
+
+// Largest difference between the parameters and bias of a model and the reference.
+double distance(const LinearModel<double, number_of_inputs, number_of_outputs>& model, const Equations::ParameterType& W, const Equations::OutputType& b)
+{
+	return std::max((model.get_param() - W).cwiseAbs().maxCoeff(), (model.get_bias() - b).cwiseAbs().maxCoeff());
+}
+
+bool report(const std::string& name, double difference, double tolerance)
+{
+	bool ok = difference <= tolerance;
+	std::cout << name << " : largest difference " << difference << (ok ? "" : " FAILED") << std::endl;
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	int samples = (argc > 1) ? std::stoi(argv[1]) : 5000;
+	const double ridge = 10;
+
+	// y = W x + b + noise
+	srand(1);
+	InputsType inputs = InputsType::Random(number_of_inputs, samples);
+	Equations::ParameterType W = Equations::ParameterType::Random();
+	Equations::OutputType b = Equations::OutputType::Random();
+	OutputsType actual = (W * inputs).colwise() + b;
+	actual += 0.01 * OutputsType::Random(number_of_outputs, samples);
+
+	// References from the design matrix [Xᵀ 1], solved in long double with the normal
+	// equations written out in full, once without and once with the ridge.
+	using Reference = Eigen::Matrix<long double, number_of_inputs + 1, Eigen::Dynamic>;
+	Reference X(number_of_inputs + 1, samples);
+	X << inputs.cast<long double>(), Eigen::Matrix<long double, 1, Eigen::Dynamic>::Ones(samples);
+	Eigen::Matrix<long double, number_of_inputs + 1, number_of_inputs + 1> A = X * X.transpose();
+	Eigen::Matrix<long double, number_of_inputs + 1, number_of_outputs> Xy = X * actual.cast<long double>().transpose();
+	Equations::CrossType w_ls = A.ldlt().solve(Xy).cast<double>();
+	A.diagonal().head(number_of_inputs).array() += ridge;
+	Equations::CrossType w_ridge = A.ldlt().solve(Xy).cast<double>();
+	Equations::ParameterType W_ls = w_ls.topRows(number_of_inputs).transpose(), W_ridge = w_ridge.topRows(number_of_inputs).transpose();
+	Equations::OutputType b_ls = w_ls.row(number_of_inputs).transpose(), b_ridge = w_ridge.row(number_of_inputs).transpose();
+
+	bool ok = true;
+
+	Model llt(0, LeastSquaresSolver::Cholesky);
+	for(int i = 0; i < samples; ++i) llt.train(inputs.col(i), actual.col(i));
+	ok &= llt.solve() && report("Cholesky, sample by sample", distance(llt, W_ls, b_ls), 1e-9);
+
+	Model ldlt(0, LeastSquaresSolver::LDLT);
+	ok &= ldlt.fit(inputs, actual, 4) && report("LDLT, blocks over 4 threads", distance(ldlt, W_ls, b_ls), 1e-9);
+
+	Model ridged(ridge);
+	ok &= ridged.fit(inputs, actual) && report("LDLT, ridge 10", distance(ridged, W_ridge, b_ridge), 1e-9);
+	bool shrinks = ridged.get_param().norm() < ldlt.get_param().norm();
+	std::cout << "weight norm " << ldlt.get_param().norm() << ", with the ridge " << ridged.get_param().norm() << (shrinks ? "" : " FAILED") << std::endl;
+	ok &= shrinks;
+
+	RLSModel rls(1e-6);
+	for(int i = 0; i < samples; ++i) rls.train(inputs.col(i), actual.col(i));
+	ok &= report("recursive least squares", distance(rls, W_ls, b_ls), 1e-6);
+	ok &= report("against the target", distance(ldlt, W, b), 1e-2);
+
+	// An input that is always 0 leaves the Gram matrix singular until it is regularized.
+	InputsType degenerate = inputs;
+	degenerate.row(0).setZero();
+	Model singular(0, LeastSquaresSolver::Cholesky), regularized(1e-3, LeastSquaresSolver::Cholesky);
+	bool detected = !singular.fit(degenerate, actual) && regularized.fit(degenerate, actual);
+	std::cout << "singular system " << (detected ? "reported" : "NOT reported") << std::endl;
+	ok &= detected;
+
+	std::cout << (ok ? "ok" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
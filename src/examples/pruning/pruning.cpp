@@ -0,0 +1,111 @@
+//
+//  pruning.cpp
+//  Pruning
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Prunes a large random policy to increasing sparsity, globally and layer by layer, and
+//  compares the dense and the sparse kernel at each: the time per forward pass, the bytes
+//  of parameters, which kernel sparsify() picks, and how far the sparse outputs are from
+//  the pruned dense network. The crossover it shows is SparseLayer::default_max_density.
+//
+//  usage: pruning [states]
+//
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/plain_neural_network.hpp"
+#include "src/network/perceptron_layer.hpp"
+#include "src/network/pruning.hpp"
+#include "src/network/sparse_layer.hpp"
+
+using namespace neural;
+
+using NN  = NeuralNetwork<ReLULayerF<64, 256>, ReLULayerF<256, 128>, ReLULayerF<128, 4>>;
+using SNN = sparse_t<NN>;
+
+// Nanoseconds per call of f over every state, best of five runs.
+template <typename F>
+double time_per_state(const std::vector<NN::InputType>& states, F f) {
+	double best = 1e300;
+	for(int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for(const auto& state : states) f(state);
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / states.size());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_states = argc > 1 ? std::stoi(argv[1]) : 2000;
+
+	NN network;
+	GaussianInitializer gauss(0, 0.2);
+	for_each_layer(network, [&gauss](size_t index, auto& layer) { gauss.initialize(layer, 0, index); });
+
+	std::vector<NN::InputType> states(number_of_states);
+	for(size_t i = 0; i < states.size(); ++i) gauss.initialize(states[i], 1, i);
+
+	std::cout << "pruned  scope      density  dense ns  sparse ns  picked   bytes   largest error" << std::endl;
+	float sink = 0;
+	for(double fraction : {0.0, 0.5, 0.75, 0.8, 0.85, 0.9, 0.92, 0.95, 0.98})
+	{
+		for(bool global : {true, false})
+		{
+			NN pruned = network;
+			if(global) prune_fraction(pruned, fraction);
+			else prune_fraction_per_layer(pruned, fraction);
+
+			size_t nonzero = 0, total = 0;
+			for_each_layer(pruned, [&](size_t, const auto& layer) {
+				nonzero += std::lround(density(layer) * layer.get_weight().size());
+				total += layer.get_weight().size();
+			});
+
+			SNN dense = sparsify(pruned, 0.0);
+			SNN sparse = sparsify(pruned, 1.0);
+			SNN picked = sparsify(pruned);
+
+			double error = 0;
+			for(const auto& state : states)
+				error = std::max<double>(error, (pruned.feed_forward(state) - picked.feed_forward(state)).cwiseAbs().maxCoeff());
+
+			double t_dense  = time_per_state(states, [&](const NN::InputType& s) { sink += dense.feed_forward(s)(0); });
+			double t_sparse = time_per_state(states, [&](const NN::InputType& s) { sink += sparse.feed_forward(s)(0); });
+
+			size_t bytes = 0, sparse_layers = 0;
+			for_each_layer(picked, [&](size_t, const auto& layer) { bytes += layer.parameter_bytes(); sparse_layers += layer.is_sparse(); });
+
+			std::cout << fraction << "\t" << (global ? "global   " : "per layer") << "  " << (double)nonzero/total
+					  << "\t" << t_dense << "\t" << t_sparse << "\t" << sparse_layers << " sparse\t" << bytes << "\t" << error << std::endl;
+		}
+	}
+
+	// Round trip through the sparse text format.
+	NN pruned = network;
+	prune_fraction(pruned, 0.9);
+	SNN picked = sparsify(pruned);
+	{
+		std::ofstream file("pruned.txt");
+		save_to_file(file, picked);
+	}
+	SNN read;
+	{
+		std::ifstream file("pruned.txt");
+		read_from_file(file, read);
+	}
+	double difference = 0;
+	for(const auto& state : states)
+		difference = std::max<double>(difference, (picked.feed_forward(state) - read.feed_forward(state)).cwiseAbs().maxCoeff());
+	std::cout << "sparse file round trip, largest output difference: " << difference << (sink == 0.5f ? " " : "") << std::endl;
+	return 0;
+}
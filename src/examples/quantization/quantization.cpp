@@ -0,0 +1,120 @@
+//
+//  quantization.cpp
+//  Quantization
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Evolves a Snake network for a few generations, calibrates an int8 copy of it on the
+//  states it visits, and compares the two: how often they choose the same move, how far
+//  apart their outputs are, the time per forward pass and the bytes of weights. A
+//  network this small spends most of a pass on activations and conversions; the int8
+//  kernel pulls ahead once layers have a hundred or so inputs.
+//
+//  usage: quantization [generations] [population]
+//
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/genetic_algorithm_neural_network.hpp"
+#include "src/network/quantized_layer.hpp"
+#include "src/examples/snake_game/vector_snake.hpp"
+
+using namespace neural;
+
+using NN  = NeuralNetwork<SigmoidLayer<8, 20>, SigmoidLayer<20, 4>>;
+using QNN = quantized_t<NN>;
+
+// Nanoseconds per call of f over every state, best of five runs.
+template <typename F>
+double time_per_state(const std::vector<NN::InputType>& states, F f) {
+	double best = 1e300;
+	for(int run = 0; run < 5; ++run)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for(const auto& state : states) f(state);
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / states.size());
+	}
+	return best;
+}
+
+// Every state a network sees playing number_of_boards boards.
+std::vector<NN::InputType> visited_states(const NN& network, int number_of_boards, unsigned int seed)
+{
+	std::vector<NN::InputType> states;
+	VectorSnake env(number_of_boards, seed);
+	while(!env.all_done())
+	{
+		for(int b = 0; b < env.number_of_boards(); ++b)
+			if(!env.done(b)) states.push_back(env.inputs().col(b));
+		env.step(network.feed_forward_batch(env.inputs()));
+	}
+	return states;
+}
+
+int main(int argc, char** argv)
+{
+	int generations = argc > 1 ? std::stoi(argv[1]) : 20;
+	int population_size = argc > 2 ? std::stoi(argv[2]) : 500;
+
+	GeneticAlgorithm<VectorSnakeScorer<NN>, NN> genetic_algorithm(population_size);
+	GaussianInitializer gauss(0, 1);
+	genetic_algorithm.initialize(gauss);
+	for(int g = 0; g < generations; ++g)
+	{
+		genetic_algorithm.get_scores();
+		genetic_algorithm.evolve(population_size/10, 0.05);
+	}
+	genetic_algorithm.get_scores();
+	genetic_algorithm.sort_by_scores();
+	const NN& network = *genetic_algorithm.population[0].first;
+
+	std::vector<NN::InputType> calibration = visited_states(network, 64, 1);
+	std::vector<NN::InputType> test = visited_states(network, 256, 2);
+	QNN quantized = calibrate(network, calibration);
+	NeuralNetwork<SigmoidLayerF<8, 20>, SigmoidLayerF<20, 4>> single(SigmoidLayerF<8, 20>(std::get<0>(network.layers).get_weight().cast<float>()),
+																	 SigmoidLayerF<20, 4>(std::get<1>(network.layers).get_weight().cast<float>()));
+
+	// Saturated sigmoids often tie for the best move, and any rounding breaks the tie, so
+	// agreement is also counted only where the best output leads by more than 0.01.
+	int agree = 0, clear = 0, agree_clear = 0;
+	double error = 0;
+	for(const auto& state : test)
+	{
+		NN::OutputType a = network.feed_forward(state);
+		NN::OutputType b = quantized.feed_forward(state.cast<float>()).cast<double>();
+		Eigen::Index move_a, move_b;
+		a.maxCoeff(&move_a);
+		b.maxCoeff(&move_b);
+		agree += move_a == move_b;
+		NN::OutputType sorted = a;
+		std::sort(sorted.data(), sorted.data() + sorted.size());
+		if(sorted(NN::OutputSize-1) - sorted(NN::OutputSize-2) > 0.01)
+		{
+			++clear;
+			agree_clear += move_a == move_b;
+		}
+		error = std::max(error, (a - b).cwiseAbs().maxCoeff());
+	}
+
+	float sink = 0;
+	double t_double = time_per_state(test, [&](const NN::InputType& s) { sink += network.feed_forward(s)(0); });
+	double t_float  = time_per_state(test, [&](const NN::InputType& s) { sink += single.feed_forward(s.cast<float>())(0); });
+	double t_int8   = time_per_state(test, [&](const NN::InputType& s) { sink += quantized.feed_forward(s.cast<float>())(0); });
+
+	size_t bytes_int8 = 0;
+	std::apply([&bytes_int8](const auto&... layers) { ((bytes_int8 += layers.parameter_bytes), ...); }, quantized.layers);
+
+	std::cout << "best score     : " << genetic_algorithm.population[0].second << " over " << genetic_algorithm.scorer.number_of_boards << " boards" << std::endl;
+	std::cout << "same move      : " << agree << " of " << test.size() << " states, " << agree_clear << " of " << clear << " without a near tie" << std::endl;
+	std::cout << "largest error  : " << error << std::endl;
+	std::cout << "double         : " << t_double << " ns, " << NN::binary_size << " bytes" << std::endl;
+	std::cout << "float          : " << t_float << " ns, " << NN::binary_size/2 << " bytes" << std::endl;
+	std::cout << "int8           : " << t_int8 << " ns, " << bytes_int8 << " bytes" << (sink == 0.5f ? " " : "") << std::endl;
+	return 0;
+}
@@ -0,0 +1,68 @@
+//
+//  recurrent.cpp
+//  Recurrent
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Runs Elman and GRU networks over a sequence with feed_forward_sequence and with one
+//  step per input, both from the initial state, and checks that the outputs agree at
+//  every step and that both leave the same state behind. Fails otherwise.
+//
+//  usage: recurrent [steps]
+//
+
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/plain_neural_network.hpp"
+#include "src/network/recurrent_layer.hpp"
+#include "src/network/initialization.hpp"
+
+using namespace neural;
+
+// Largest difference between the sequence and the steps, then one more step from each
+// final state to compare the states.
+template <typename NN>
+bool check(const std::string& name, int steps, double tolerance)
+{
+	using ScalarType = typename NN::ScalarType;
+	NN network;
+	GaussianInitializer gauss(0, 0.5);
+	network.initialize(gauss, 0);
+
+	Eigen::Matrix<ScalarType, NN::InputSize, Eigen::Dynamic> inputs(NN::InputSize, steps);
+	for(int t = 0; t < steps; ++t)
+		for(int i = 0; i < NN::InputSize; ++i) inputs(i, t) = std::sin(0.3*t + i);
+
+	auto stepped_state = NN::initial_state();
+	Eigen::Matrix<ScalarType, NN::OutputSize, Eigen::Dynamic> stepped(NN::OutputSize, steps);
+	for(int t = 0; t < steps; ++t) stepped.col(t) = network.step(inputs.col(t), stepped_state);
+
+	auto sequence_state = NN::initial_state();
+	Eigen::Matrix<ScalarType, NN::OutputSize, Eigen::Dynamic> sequence = network.feed_forward_sequence(inputs, sequence_state);
+
+	typename NN::InputType last = inputs.col(0);
+	double difference = (double)(sequence - stepped).cwiseAbs().maxCoeff();
+	double state_difference = (double)(network.step(last, sequence_state) - network.step(last, stepped_state)).cwiseAbs().maxCoeff();
+
+	bool ok = difference <= tolerance && state_difference <= tolerance;
+	std::cout << name << " : largest difference " << difference << ", after the sequence " << state_difference
+		<< (ok ? "" : " FAILED") << std::endl;
+	return ok;
+}
+
+int main(int argc, char** argv)
+{
+	int steps = (argc > 1) ? std::stoi(argv[1]) : 100;
+	bool ok = true;
+	ok &= check<NeuralNetwork<ElmanTanhLayer<16, 30>, TanhLayer<30, 2>>>("elman", steps, 1e-10);
+	ok &= check<NeuralNetwork<GRULayerD<16, 30>, TanhLayer<30, 2>>>("gru", steps, 1e-10);
+	ok &= check<NeuralNetwork<ElmanLayer<float, 16, 30, sigmoid, Eigen::half>, TanhLayerF<30, 2>>>("elman float, half weights", steps, 1e-5);
+	ok &= check<NeuralNetwork<GRULayer<float, 16, 30, Eigen::bfloat16>, GRULayer<float, 30, 8>, TanhLayerF<8, 2>>>("gru float, two layers", steps, 1e-5);
+	std::cout << (ok ? "ok" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
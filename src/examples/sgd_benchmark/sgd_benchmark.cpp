@@ -0,0 +1,81 @@
+//
+//  sgd_benchmark.cpp
+//  SGD Benchmark
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Compares throughput and convergence of serial SGD against Hogwild and averaged
+//  parallel SGD on a synthetic regression problem.
+//
+//  usage: sgd_benchmark [samples] [epochs] [max threads]
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+#include "src/linear_regression/parallel_sgd.hpp"
+
+using namespace neural;
+
+static constexpr int number_of_inputs = 64;
+static constexpr int number_of_outputs = 4;
+
+using Model = GradientDescentLinearModel<double, number_of_inputs, number_of_outputs>;
+
+template <typename F>
+double time_ms(F f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& name, int threads, double ms, long samples, double mse) {
+	std::cout << std::left << std::setw(10) << name
+		<< std::right << std::setw(8) << threads
+		<< std::setw(12) << std::fixed << std::setprecision(1) << ms
+		<< std::setw(16) << std::setprecision(2) << samples / ms / 1000 
+		<< std::setw(14) << std::scientific << std::setprecision(3) << mse << std::endl;
+}
+
+int main(int argc, char **argv) {
+	int samples = (argc > 1) ? std::stoi(argv[1]) : 200000;
+	int epochs = (argc > 2) ? std::stoi(argv[2]) : 5;
+	int max_threads = (argc > 3) ? std::stoi(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+	double lambda = 0.005;
+	
+	// y = W x + b + noise
+	srand(1);
+	DatasetInputs<Model> inputs = DatasetInputs<Model>::Random(number_of_inputs, samples);
+	Model::ParameterType W = Model::ParameterType::Random();
+	Model::OutputType b = Model::OutputType::Random();
+	DatasetOutputs<Model> actual = (W * inputs).colwise() + b;
+	actual += 0.01 * DatasetOutputs<Model>::Random(number_of_outputs, samples);
+	
+	long total = (long)samples * epochs;
+	std::cout << samples << " samples, " << epochs << " epochs, " << number_of_inputs << " inputs, " << number_of_outputs << " outputs\n\n";
+	std::cout << std::left << std::setw(10) << "mode" << std::right << std::setw(8) << "threads" << std::setw(12) << "ms"
+		<< std::setw(16) << "Msamples/s" << std::setw(14) << "mse" << std::endl;
+	
+	{
+		Model model {ConstantLearningRate<double>(lambda)};
+		double ms = time_ms([&]() {
+			for(int epoch = 0; epoch < epochs; ++epoch)
+				for(int i = 0; i < samples; ++i) model.train(inputs.col(i), actual.col(i));
+		});
+		report("serial", 1, ms, total, mean_squared_error(model, inputs, actual));
+	}
+	
+	for(int threads = 1; threads <= max_threads; threads *= 2)
+	{
+		Model hogwild, averaged;
+		double ms = time_ms([&]() { parallel_sgd(hogwild, inputs, actual, lambda, epochs, threads, ParallelSGDMode::Hogwild); });
+		report("hogwild", threads, ms, total, mean_squared_error(hogwild, inputs, actual));
+		ms = time_ms([&]() { parallel_sgd(averaged, inputs, actual, lambda, epochs, threads, ParallelSGDMode::Averaged); });
+		report("averaged", threads, ms, total, mean_squared_error(averaged, inputs, actual));
+	}
+}
@@ -0,0 +1,80 @@
+//
+//  occupancy.hpp
+//  Snake
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+
+#ifndef SNAKE_OCCUPANCY_HPP_
+#define SNAKE_OCCUPANCY_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cassert>
+
+/*
+ *  Occupancy grid.
+ *
+ *  One bit per cell so collision and sensor checks are a single bit test, and a dense
+ *  list of the free cells (with each cell's position in it) so that occupying, freeing
+ *  and sampling a free cell are all constant time. Cells are addressed by their index
+ *  row*BoardSize + col.
+ */
+
+template <int BoardSize>
+struct Occupancy {
+	static constexpr int number_of_cells = BoardSize*BoardSize;
+	static constexpr int number_of_words = (number_of_cells + 63)/64;
+
+	Occupancy() { clear(); }
+
+	void clear() {
+		bits.fill(0);
+		for(int i = 0; i < number_of_cells; ++i) {
+			free_cells[i] = i;
+			position[i] = i;
+		}
+		free_count = number_of_cells;
+	}
+
+	bool test(int i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+
+	void set(int i) {
+		assert(!test(i));
+		bits[i >> 6] |= uint64_t(1) << (i & 63);
+		// Swap with the last free cell, then shrink the free list.
+		move_free_cell(i, --free_count);
+	}
+
+	void reset(int i) {
+		assert(test(i));
+		bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+		// Swap with the first occupied cell, then grow the free list.
+		move_free_cell(i, free_count++);
+	}
+
+	// Maps any random number to a free cell.
+	int free_cell(unsigned int r) const {
+		assert(free_count > 0);
+		return free_cells[r % free_count];
+	}
+
+	int number_of_free_cells() const { return free_count; }
+
+private :
+	void move_free_cell(int i, int k) {
+		int other = free_cells[k];
+		free_cells[position[i]] = other;
+		position[other] = position[i];
+		free_cells[k] = i;
+		position[i] = k;
+	}
+
+	std::array<uint64_t, number_of_words> bits;
+	std::array<int16_t, number_of_cells> free_cells;
+	std::array<int16_t, number_of_cells> position;
+	int free_count;
+};
+
+#endif /* SNAKE_OCCUPANCY_HPP_ */
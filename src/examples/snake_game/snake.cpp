@@ -9,7 +9,13 @@
 #ifndef SNAKE_HPP_
 #define SNAKE_HPP_
 
+#include <chrono>
+
 #include "snake.hpp"
+#include "vector_snake.hpp"
+#include "src/network/evolution_strategies.hpp"
+#include "src/network/steady_state_genetic_algorithm.hpp"
+#include "src/network/racing.hpp"
 
 
 using RL = neural::SigmoidLayer<8, 20>;
@@ -18,7 +24,101 @@ using NN = neural::NeuralNetwork<RL, SL>;
 
 SnakeGame SnakeGame::current_game = SnakeGame(SnakeGeneticAlgorithm<NN>::gameOver);
 
+// snake --headless <generations> [trace.json]
+int headless_main(int generations, const char* trace_file) {
+    if(trace_file) neural::trace_start(trace_file);
+    using SGA = SnakeGeneticAlgorithm<NN>;
+    neural::GaussianInitializer gauss(0,1);
+    SGA::genetic_algorithm.number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    SGA::genetic_algorithm.initialize(gauss);
+    
+    VectorSnake env(SGA::genetic_algorithm.population_size);
+    neural::ProfileReport profile_report(10);
+    for(int generation = 1; generation <= generations; ++generation)
+    {
+    	auto start = std::chrono::steady_clock::now();
+    	env.reset(generation);
+    	{
+    		neural::ProfileScope scope(neural::ProfilePhase::Evaluation);
+    		play_population(env, SGA::genetic_algorithm.population);
+    	}
+    	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    	
+    	int best = 0;
+    	for(const auto& p : SGA::genetic_algorithm.population) best = std::max(best, p.second);
+    	std::cout << generation << " : " << best << " (" << ms << " ms)" << std::endl;
+    	
+    	SGA::genetic_algorithm.evolve(50, 0.05);
+    	profile_report.generation_done(generation);
+    }
+    neural::trace_stop();
+    return 0;
+}
+
+// snake --es <generations>
+int es_main(int generations) {
+    neural::EvolutionStrategies<VectorSnakeScorer<NN>, NN> es(100, 0.5, 0.1);
+    es.number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    es.initialize(neural::GaussianInitializer(0, 1));
+    
+    for(int generation = 1; generation <= generations; ++generation)
+    {
+    	auto start = std::chrono::steady_clock::now();
+    	es.scorer.seed = generation;
+    	es.step();
+    	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    	
+    	std::cout << generation << " : " << es.best_score << " (" << ms << " ms)" << std::endl;
+    }
+    return 0;
+}
+
+// snake --steady <births>
+int steady_main(int births) {
+    neural::GeneticAlgorithm<VectorSnakeScorer<NN>, NN> genetic_algorithm(1000);
+    neural::GaussianInitializer gauss(0, 1);
+    genetic_algorithm.initialize(gauss);
+    
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    neural::SteadyStateGA<VectorSnakeScorer<NN>, NN> steady(genetic_algorithm, 0.05, 2*threads);
+    auto start = std::chrono::steady_clock::now();
+    steady.run(births, threads);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    int best = 0;
+    for(const auto& p : genetic_algorithm.population) best = std::max(best, p.second);
+    std::cout << steady.get_births() << " births : " << best << " (" << ms << " ms)" << std::endl;
+    return 0;
+}
+
+// snake --race <generations>
+int race_main(int generations) {
+    neural::GeneticAlgorithm<VectorSnakeScorer<NN>, NN> genetic_algorithm(1000);
+    neural::GaussianInitializer gauss(0, 1);
+    genetic_algorithm.number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    genetic_algorithm.initialize(gauss);
+    genetic_algorithm.scorer.number_of_boards = 2;	// One episode.
+    
+    for(int generation = 1; generation <= generations; ++generation)
+    {
+    	auto start = std::chrono::steady_clock::now();
+    	neural::Race race(genetic_algorithm.population_size, 50, 4, 20, generation * 20);
+    	race.run(genetic_algorithm.population, genetic_algorithm.scorer, genetic_algorithm.number_of_threads);
+    	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    	
+    	std::vector<double> means = race.means();
+    	std::cout << generation << " : " << *std::max_element(means.begin(), means.end()) << " (" 
+    		<< race.get_episodes_used() << " episodes, " << ms << " ms)" << std::endl;
+    	genetic_algorithm.evolve(50, 0.05, means);
+    }
+    return 0;
+}
+
 int main(int argc, char **argv) {
+	if (argc > 2 && std::string(argv[1]) == "--headless") return headless_main(std::stoi(argv[2]), argc > 3 ? argv[3] : nullptr);
+	if (argc > 2 && std::string(argv[1]) == "--es") return es_main(std::stoi(argv[2]));
+	if (argc > 2 && std::string(argv[1]) == "--steady") return steady_main(std::stoi(argv[2]));
+	if (argc > 2 && std::string(argv[1]) == "--race") return race_main(std::stoi(argv[2]));
 	
 	glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
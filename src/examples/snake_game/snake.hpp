@@ -35,6 +35,8 @@
 #define CELL_SIZE 20
 #define BOARD_SIZE 20
 
+#include "occupancy.hpp"
+
 // Game objects.
 
 struct Cell {
@@ -84,9 +86,12 @@ struct Cell {
 	}
 	
 	bool is_out_of_bounds() {
-		return (row < 0 || row >= Y_WINDOW_SIZE || col < 0 || X_WINDOW_SIZE);
+		return (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE);
 	}
 	
+	int index() const { return row*BOARD_SIZE + col; }
+	static Cell from_index(int i) { return Cell(i / BOARD_SIZE, i % BOARD_SIZE); }
+	
 	int row;
 	int col;
 };
@@ -96,10 +101,14 @@ struct Snake {
 	Snake() : dir{Cell::Direction::right}
 	{
 		tail.push_back(Cell());
+		occupied.set(tail.back().index());
 	}
 	
 	Cell head() { return tail.front(); }
 	
+	// True if moving into c would kill the snake.
+	bool blocked(Cell c) const { return c.is_out_of_bounds() || occupied.test(c.index()); }
+	
 	bool update_position() {
 		Cell next = tail.front();
 		
@@ -118,15 +127,17 @@ struct Snake {
 				break;
 		}
 		
-		if (find(tail.begin(), tail.end(), next) != tail.end()) return false;
-		if (next.row < 0 || next.row >= BOARD_SIZE) return false;
-		if (next.col < 0 || next.col >= BOARD_SIZE) return false;
+		if (blocked(next)) return false;
 		
 		tail.push_front(next);
+		occupied.set(next.index());
 		return true;
 	}
 	
-	void delete_tail() { tail.pop_back(); }
+	void delete_tail() {
+		occupied.reset(tail.back().index());
+		tail.pop_back();
+	}
 	
 	
 	void draw() {
@@ -140,6 +151,7 @@ struct Snake {
 	
 	Cell::Direction dir;
 	std::deque<Cell> tail;
+	Occupancy<BOARD_SIZE> occupied;
 };
 
 
@@ -171,10 +183,7 @@ struct SnakeGame
 	
 	Cell random_cell()
 	{
-		Cell res = Cell(rand() % BOARD_SIZE, rand() % BOARD_SIZE);
-		while (find(snake.tail.begin(), snake.tail.end(), res) != snake.tail.end())
-			res = Cell(rand() % BOARD_SIZE, rand() % BOARD_SIZE);
-		return res;
+		return Cell::from_index(snake.occupied.free_cell(rand()));
 	}
 	
 	void timer(int)
@@ -251,25 +260,23 @@ void keyboard(unsigned char key, int x, int y) {
 template <typename NetworkType>
 struct SnakeGameAI {
 	
-	SnakeGameAI(NetworkType& nn_) {
-		network = nn_;
-	}
+	// The AI reads the weights where they are, so nn_ must outlive the game.
+	SnakeGameAI(const NetworkType& nn_) : network{&nn_} {}
 	
-	void set_network(NetworkType& nn_) {
-		network = nn_;
+	void set_network(const NetworkType& nn_) {
+		network = &nn_;
 	}
 	
 	NetworkType::InputType input() {
 		auto obstacle = [](Cell::Direction dir) {
-			Cell c = SnakeGame::current_game.snake.head().move(dir);
-			return (c.is_out_of_bounds() || (find(SnakeGame::current_game.snake.begin(), SnakeGame::current_game.snake.end(), c) != SnakeGame::current_game.snake.end()));
+			return SnakeGame::current_game.snake.blocked(SnakeGame::current_game.snake.head().move(dir));
 		};
 		
 		return {
-			SnakeGame::current_game.snake.head().row/(Y_WINDOW_SIZE/2),
-			SnakeGame::current_game.snake.head().col/(X_WINDOW_SIZE/2),
-			SnakeGame::current_game.food.row/(Y_WINDOW_SIZE/2),
-			SnakeGame::current_game.food.col/(X_WINDOW_SIZE/2),
+			SnakeGame::current_game.snake.head().row/(double)BOARD_SIZE,
+			SnakeGame::current_game.snake.head().col/(double)BOARD_SIZE,
+			SnakeGame::current_game.food.row/(double)BOARD_SIZE,
+			SnakeGame::current_game.food.col/(double)BOARD_SIZE,
 			obstacle(Cell::Direction::up),
 			obstacle(Cell::Direction::down),
 			obstacle(Cell::Direction::left),
@@ -278,7 +285,7 @@ struct SnakeGameAI {
 	}
 	
 	NetworkType::OutputType output() {
-		return network.feed_forward(input());
+		return network->feed_forward(input());
 	}
 	
 	void action() {
@@ -302,7 +309,7 @@ struct SnakeGameAI {
 		}
 	}
 	
-	NetworkType network;
+	const NetworkType* network;
 };
 
 
@@ -318,7 +325,7 @@ struct SnakeScorer {
 		return a > b;
 	}
 	
-	OutputType operator()(InputType& input) {
+	OutputType operator()(const InputType& input) {
 		return 3;
 	}
 };
@@ -342,7 +349,7 @@ template <typename NetworkType>
 neural::GeneticAlgorithm<SnakeScorer<NetworkType>, NetworkType> SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm{200};
 
 template <typename NetworkType>
-SnakeGameAI<NetworkType> SnakeGeneticAlgorithm<NetworkType>::AI{SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm.population[0].first};
+SnakeGameAI<NetworkType> SnakeGeneticAlgorithm<NetworkType>::AI{*SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm.population[0].first};
 
 template <typename NetworkType>
 void SnakeGeneticAlgorithm<NetworkType>::gameOver() {
@@ -352,7 +359,7 @@ void SnakeGeneticAlgorithm<NetworkType>::gameOver() {
 		SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm.evolve(50, 0.05);
 	}
 	else ++SnakeGeneticAlgorithm<NetworkType>::index;
-	SnakeGeneticAlgorithm<NetworkType>::AI.set_network(SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm.population[SnakeGeneticAlgorithm<NetworkType>::index].first);
+	SnakeGeneticAlgorithm<NetworkType>::AI.set_network(*SnakeGeneticAlgorithm<NetworkType>::genetic_algorithm.population[SnakeGeneticAlgorithm<NetworkType>::index].first);
 	SnakeGame::current_game = SnakeGame(SnakeGeneticAlgorithm<NetworkType>::gameOver);
 }
 
@@ -0,0 +1,259 @@
+//
+//  vector_snake.hpp
+//  Snake
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+
+#ifndef VECTOR_SNAKE_HPP_
+#define VECTOR_SNAKE_HPP_
+
+#include <Eigen/Dense>
+#include <array>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cassert>
+
+#include "occupancy.hpp"
+#include "src/network/trace.hpp"
+
+/*
+ *  Headless batched Snake.
+ *
+ *  Steps a number of independent boards in lockstep with the same rules as SnakeGame,
+ *  but without OpenGL, global state or the global rand(): every board owns its RNG and
+ *  keeps its body in a fixed capacity ring buffer. The inputs of all boards are written
+ *  as the columns of one 8 x B matrix, so a single network can be fed the whole batch at
+ *  once with NeuralNetwork::feed_forward_batch.
+ */
+
+class VectorSnake
+{
+public :
+	static constexpr int board_size = 20;
+	static constexpr int number_of_cells = board_size*board_size;
+	static constexpr int max_hunger = 200;
+
+	static constexpr int NumInputs = 8;
+	static constexpr int NumActions = 4;
+
+	using InputMatrix  = Eigen::Matrix<double, NumInputs, Eigen::Dynamic>;
+	using OutputMatrix = Eigen::Matrix<double, NumActions, Eigen::Dynamic>;
+
+	// Same values as Cell::Direction.
+	enum Direction {
+		left	= 0,
+		right	= 1,
+		up		= 2,
+		down	= 3
+	};
+
+	VectorSnake(int number_of_boards_, unsigned int seed = 0)
+		: boards(number_of_boards_)
+		, input_matrix(NumInputs, number_of_boards_)
+	{
+		reset(seed);
+	}
+
+	void reset(unsigned int seed)
+	{
+		for(size_t b = 0; b < boards.size(); ++b)
+		{
+			Board& board = boards[b];
+			std::seed_seq seq {seed, (unsigned int)b};
+			board.gen.seed(seq);
+			board.occupied.clear();
+			board.first = 0;
+			board.length = 0;
+			push_front(board, 0);
+			board.food = board.occupied.free_cell(board.gen());
+			board.dir = right;
+			board.score = 0;
+			board.hunger = max_hunger;
+			board.done = false;
+		}
+		number_done = 0;
+	}
+
+	// Column b holds the same inputs SnakeGameAI::input computes for board b.
+	const InputMatrix& inputs()
+	{
+		for(size_t b = 0; b < boards.size(); ++b)
+		{
+			const Board& board = boards[b];
+			int head = board.body[board.first];
+			input_matrix.col(b) <<
+				(head / board_size)/(double)board_size,
+				(head % board_size)/(double)board_size,
+				(board.food / board_size)/(double)board_size,
+				(board.food % board_size)/(double)board_size,
+				blocked(board, head, up),
+				blocked(board, head, down),
+				blocked(board, head, left),
+				blocked(board, head, right);
+		}
+		return input_matrix;
+	}
+
+	// Steps every board that is still alive, turning towards the largest output of its column.
+	void step(const OutputMatrix& outputs)
+	{
+		assert(outputs.cols() == (int)boards.size());
+		neural::TraceSpan span("step", "snake", "boards", boards.size());
+		static constexpr Direction action_to_direction[NumActions] = {left, up, down, right};
+
+		for(size_t b = 0; b < boards.size(); ++b)
+		{
+			Board& board = boards[b];
+			if(board.done) continue;
+
+			int max_index;
+			outputs.col(b).maxCoeff(&max_index);
+			board.dir = action_to_direction[max_index];
+
+			int next = move(board.body[board.first], board.dir);
+			if(next < 0 || board.occupied.test(next) || board.hunger <= 0)
+			{
+				finish(board);
+				continue;
+			}
+
+			push_front(board, next);
+			if(next != board.food)
+			{
+				pop_back(board);
+				--board.hunger;
+			}
+			else
+			{
+				board.score++;
+				board.hunger = max_hunger;
+				if(board.occupied.number_of_free_cells() == 0) finish(board);
+				else board.food = board.occupied.free_cell(board.gen());
+			}
+		}
+	}
+
+	int number_of_boards() const { return boards.size(); }
+	bool all_done() const { return number_done == (int)boards.size(); }
+	bool done(int b) const { return boards[b].done; }
+	int score(int b) const { return boards[b].score; }
+	int length(int b) const { return boards[b].length; }
+
+private :
+	struct Board {
+		std::array<uint16_t, number_of_cells> body;
+		int first;
+		int length;
+		Occupancy<board_size> occupied;
+		int food;
+		Direction dir;
+		int score;
+		int hunger;
+		bool done;
+		std::default_random_engine gen;
+	};
+
+	// Returns the index of the neighbouring cell, or -1 if it is off the board.
+	static int move(int cell, Direction dir)
+	{
+		int row = cell / board_size, col = cell % board_size;
+		switch(dir) {
+			case(left) :	--col; break;
+			case(right) :	++col; break;
+			case(up) :		--row; break;
+			case(down) :	++row; break;
+		}
+		if(row < 0 || row >= board_size || col < 0 || col >= board_size) return -1;
+		return row*board_size + col;
+	}
+
+	static bool blocked(const Board& board, int cell, Direction dir)
+	{
+		int next = move(cell, dir);
+		return next < 0 || board.occupied.test(next);
+	}
+
+	static void push_front(Board& board, int cell)
+	{
+		board.first = (board.first + number_of_cells - 1) % number_of_cells;
+		board.body[board.first] = cell;
+		board.occupied.set(cell);
+		++board.length;
+	}
+
+	static void pop_back(Board& board)
+	{
+		int last = (board.first + board.length - 1) % number_of_cells;
+		board.occupied.reset(board.body[last]);
+		--board.length;
+	}
+
+	void finish(Board& board)
+	{
+		board.done = true;
+		++number_done;
+	}
+
+	std::vector<Board> boards;
+	InputMatrix input_matrix;
+	int number_done;
+};
+
+// Plays one episode of a single network on every board, with one batched forward pass per step.
+template <typename NetworkType>
+void play_network(VectorSnake& env, const NetworkType& network)
+{
+	while(!env.all_done()) env.step(network.feed_forward_batch(env.inputs()));
+}
+
+// Plays one episode per individual, individual b on board b, and stores the scores in the population.
+template <typename PopulationType>
+void play_population(VectorSnake& env, std::vector<PopulationType>& population)
+{
+	assert(env.number_of_boards() == (int)population.size());
+	neural::TraceSpan span("play_population", "snake", "boards", env.number_of_boards());
+	VectorSnake::OutputMatrix outputs = VectorSnake::OutputMatrix::Zero(VectorSnake::NumActions, env.number_of_boards());
+
+	while(!env.all_done())
+	{
+		const VectorSnake::InputMatrix& inputs = env.inputs();
+		for(int b = 0; b < env.number_of_boards(); ++b)
+			if(!env.done(b)) outputs.col(b) = population[b].first->feed_forward(inputs.col(b));
+		env.step(outputs);
+	}
+	for(int b = 0; b < env.number_of_boards(); ++b) population[b].second = env.score(b);
+}
+
+// Scores a single network by its total over number_of_boards boards. Every network scored
+// with the same seed sees the same boards, so the two halves of an antithetic pair are
+// compared on equal terms.
+template <typename NetworkType>
+struct VectorSnakeScorer {
+	using OutputType = int;
+	using InputType = NetworkType;
+
+	bool compare(OutputType a, OutputType b) {
+		return a > b;
+	}
+
+	OutputType operator()(const InputType& input) {
+		return (*this)(input, seed);
+	}
+
+	// The same boards for every network given the same seed, for racing (see racing.hpp).
+	OutputType operator()(const InputType& input, unsigned int seed_) {
+		VectorSnake env(number_of_boards, seed_);
+		play_network(env, input);
+		int total = 0;
+		for(int b = 0; b < number_of_boards; ++b) total += env.score(b);
+		return total;
+	}
+
+	int number_of_boards = 16;
+	unsigned int seed = 0;
+};
+
+#endif /* VECTOR_SNAKE_HPP_ */
@@ -0,0 +1,115 @@
+//
+//  sparse_regression.cpp
+//  Sparse Regression
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Fits a known sparse linear target with SparseLinearModel, once from a CSR dataset with
+//  one column per input and once from index/value samples with 64 bit feature ids hashed
+//  into the weights, and checks that both recover the target weights and that every input
+//  form predicts the same. Fails otherwise.
+//
+//  usage: sparse_regression [samples] [epochs]
+//
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/linear_regression/sparse_linear_model.hpp"
+
+using namespace neural;
+
+static constexpr int number_of_outputs = 2;
+static constexpr int number_of_features = 1000;
+static constexpr int features_per_sample = 10;
+
+using DenseModel  = SparseLinearModel<double, number_of_outputs>;
+using HashedModel = HashedLinearModel<double, number_of_outputs>;
+
+// Feature f as a 64 bit id, far outside any dense range.
+uint64_t feature_id(int f) { return (uint64_t)(f + 1) * 0x9e3779b97f4a7c15ULL; }
+
+int main(int argc, char **argv) {
+	int samples = (argc > 1) ? std::stoi(argv[1]) : 20000;
+	int epochs = (argc > 2) ? std::stoi(argv[2]) : 10;
+	const double tolerance = 1e-2;
+
+	// y = W x + b, W non-zero for one feature in ten.
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> uniform(-1, 1);
+	std::uniform_int_distribution<int> pick(0, number_of_features - 1);
+	DenseModel::ParameterType W = DenseModel::ParameterType::Zero(number_of_outputs, number_of_features);
+	for(int f = 0; f < number_of_features; f += 10) for(int o = 0; o < number_of_outputs; ++o) W(o, f) = uniform(gen);
+	DenseModel::OutputType b = DenseModel::OutputType::Constant(0.5);
+
+	std::vector<Eigen::Triplet<double>> triplets;
+	std::vector<SparseSample<double>> hashed_inputs(samples);
+	Eigen::Matrix<double, number_of_outputs, Eigen::Dynamic> actual(number_of_outputs, samples);
+	for(int i = 0; i < samples; ++i)
+	{
+		std::vector<int> features;
+		while((int)features.size() < features_per_sample)
+		{
+			int f = pick(gen);
+			if(std::find(features.begin(), features.end(), f) == features.end()) features.push_back(f);
+		}
+		actual.col(i) = b;
+		for(int f : features)
+		{
+			double x = uniform(gen);
+			triplets.emplace_back(i, f, x);
+			hashed_inputs[i].emplace_back(feature_id(f), x);
+			actual.col(i) += x * W.col(f);
+		}
+	}
+	DenseModel::DatasetType dataset(samples, number_of_features);
+	dataset.setFromTriplets(triplets.begin(), triplets.end());
+	dataset.makeCompressed();
+
+	// CSR path, one column per feature.
+	DenseModel dense(number_of_features, ConstantLearningRate<double>(0.05));
+	dense.train(dataset, actual, epochs);
+	double dense_error = (dense.get_param() - W).cwiseAbs().maxCoeff();
+	dense_error = std::max(dense_error, (dense.get_bias() - b).cwiseAbs().maxCoeff());
+
+	// Hashed path. Features that share a slot share a weight, so only the others are compared.
+	HashedModel hashed(1 << 20, ConstantLearningRate<double>(0.05));
+	for(int epoch = 0; epoch < epochs; ++epoch)
+		for(int i = 0; i < samples; ++i) hashed.train(hashed_inputs[i], actual.col(i));
+	std::vector<size_t> slots(number_of_features);
+	for(int f = 0; f < number_of_features; ++f) slots[f] = HashedIndexing::slot(feature_id(f), hashed.number_of_slots());
+	double hashed_error = (hashed.get_bias() - b).cwiseAbs().maxCoeff();
+	int collisions = 0;
+	for(int f = 0; f < number_of_features; ++f)
+	{
+		if(std::count(slots.begin(), slots.end(), slots[f]) > 1)
+		{
+			++collisions;
+			continue;
+		}
+		hashed_error = std::max(hashed_error, (hashed.get_param().col(slots[f]) - W.col(f)).cwiseAbs().maxCoeff());
+	}
+
+	// The other input forms give the same predictions as a row of the dataset.
+	double form_error = 0;
+	for(int i = 0; i < std::min(samples, 100); ++i)
+	{
+		Eigen::SparseVector<double> vector = dataset.row(i).transpose();
+		SparseSample<double> sample;
+		for(DenseModel::DatasetType::InnerIterator it(dataset, i); it; ++it) sample.emplace_back(it.col(), it.value());
+		form_error = std::max(form_error, (dense.predict(vector) - dense.predict(dataset, i)).cwiseAbs().maxCoeff());
+		form_error = std::max(form_error, (dense.predict(sample) - dense.predict(dataset, i)).cwiseAbs().maxCoeff());
+	}
+
+	std::cout << samples << " samples, " << epochs << " epochs, " << number_of_features << " features" << std::endl;
+	std::cout << "CSR    : largest weight error " << dense_error << std::endl;
+	std::cout << "hashed : largest weight error " << hashed_error << ", " << collisions << " features sharing a slot" << std::endl;
+	std::cout << "input forms : largest prediction difference " << form_error << std::endl;
+	bool ok = dense_error < tolerance && hashed_error < tolerance && collisions < number_of_features/10 && form_error < 1e-12;
+	std::cout << (ok ? "ok" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+//
+//  tensor_training.cpp
+//  Tensor Training
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Writes a synthetic regression dataset as tensor files, maps them and trains a linear
+//  model through the prefetching batch loader, checking that every epoch delivers every
+//  sample once and that the model fits the data. Fails otherwise.
+//
+//  usage: tensor_training [samples] [epochs] [batch size]
+//
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "src/dataset/tensor_file.hpp"
+#include "src/dataset/batch_loader.hpp"
+#include "src/linear_regression/parallel_sgd.hpp"
+
+using namespace neural;
+
+static constexpr int number_of_inputs = 64;
+static constexpr int number_of_outputs = 4;
+
+using Model = GradientDescentLinearModel<double, number_of_inputs, number_of_outputs>;
+
+int main(int argc, char **argv) {
+	int samples = (argc > 1) ? std::stoi(argv[1]) : 100000;
+	int epochs = (argc > 2) ? std::stoi(argv[2]) : 3;
+	int batch_size = (argc > 3) ? std::stoi(argv[3]) : 256;
+
+	// y = W x + b + noise
+	{
+		srand(1);
+		DatasetInputs<Model> inputs = DatasetInputs<Model>::Random(number_of_inputs, samples);
+		Model::ParameterType W = Model::ParameterType::Random();
+		Model::OutputType b = Model::OutputType::Random();
+		DatasetOutputs<Model> actual = (W * inputs).colwise() + b;
+		actual += 0.01 * DatasetOutputs<Model>::Random(number_of_outputs, samples);
+		if(!save_tensor("inputs.ntsr", inputs) || !save_tensor("targets.ntsr", actual)) return 1;
+	}
+
+	MappedTensor<double> inputs("inputs.ntsr"), targets("targets.ntsr");
+	if(!inputs.is_open() || !targets.is_open()) return 1;
+	if(inputs.sample_size() != number_of_inputs || targets.sample_size() != number_of_outputs)
+	{
+		std::cout << "The tensor files do not fit the model." << std::endl;
+		return 1;
+	}
+	inputs.advise(MADV_SEQUENTIAL);
+	targets.advise(MADV_SEQUENTIAL);
+
+	Model model {ConstantLearningRate<double>(0.005)};
+	std::vector<long> delivered(epochs, 0);
+	auto start = std::chrono::steady_clock::now();
+	{
+		BatchLoader<double> loader(inputs, targets, batch_size, BlockShuffleSampler(samples, 4096, 1), epochs);
+		BatchLoader<double>::Batch batch;
+		while(loader.next(batch))
+		{
+			for(size_t k = 0; k < batch.size; ++k) model.train(batch.inputs().col(k), batch.targets().col(k));
+			delivered[batch.epoch] += batch.size;
+		}
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	double mse = mean_squared_error(model, inputs.matrix(), targets.matrix());
+
+	std::cout << samples << " samples, " << epochs << " epochs, batches of " << batch_size << std::endl;
+	std::cout << ms << " ms, " << (double)samples*epochs / ms / 1000 << " Msamples/s, mse " << mse << std::endl;
+
+	bool ok = mse < 1e-3;
+	for(int epoch = 0; epoch < epochs; ++epoch)
+		if(delivered[epoch] != samples)
+		{
+			std::cout << "epoch " << epoch << " delivered " << delivered[epoch] << " samples" << std::endl;
+			ok = false;
+		}
+	std::cout << (ok ? "ok" : "FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+//
+//  worker_pool.cpp
+//  Worker Pool
+//
+//  Created by Reid Harris on 10/19/26.
+//  Copyright © 2026 Reid Harris. All rights reserved.
+//
+//  Scores a Snake population in process and with worker processes, checks that the
+//  scores agree, and optionally makes workers crash to exercise resubmission.
+//
+//  usage: worker_pool [workers] [population] [crash probability]
+//
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+#include "src/network/math_functions.hpp"
+#include "src/network/genetic_algorithm_neural_network.hpp"
+#include "src/examples/snake_game/vector_snake.hpp"
+
+using namespace neural;
+
+using NN = NeuralNetwork<SigmoidLayer<8, 20>, SigmoidLayer<20, 4>>;
+
+// Kills its worker process with probability crash_probability per network.
+struct CrashingScorer : VectorSnakeScorer<NN> {
+	OutputType operator()(const InputType& input) {
+		if(crash_probability > 0 && std::rand() < crash_probability * RAND_MAX) std::abort();
+		return VectorSnakeScorer<NN>::operator()(input);
+	}
+
+	double crash_probability = 0;
+};
+
+template <typename F>
+double time_ms(F f) {
+	auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_workers = argc > 1 ? std::stoi(argv[1]) : 4;
+	int population_size = argc > 2 ? std::stoi(argv[2]) : 1000;
+	double crash_probability = argc > 3 ? std::stod(argv[3]) : 0;
+
+	GeneticAlgorithm<CrashingScorer, NN> genetic_algorithm(population_size);
+	genetic_algorithm.scorer.number_of_boards = 32;
+	GaussianInitializer gauss(0, 1);
+	genetic_algorithm.initialize(gauss);
+
+	double serial = time_ms([&]() { genetic_algorithm.get_scores(); });
+	std::vector<int> expected;
+	for(const auto& p : genetic_algorithm.population) expected.push_back(p.second);
+
+	genetic_algorithm.scorer.crash_probability = crash_probability;
+	genetic_algorithm.use_worker_processes(number_of_workers);
+	for(auto& p : genetic_algorithm.population) p.second = -1;
+	double pooled = time_ms([&]() { genetic_algorithm.get_scores(); });
+
+	int mismatches = 0;
+	for(int i = 0; i < population_size; ++i) mismatches += genetic_algorithm.population[i].second != expected[i];
+
+	std::cout << "in process : " << serial << " ms" << std::endl;
+	std::cout << number_of_workers << " workers  : " << pooled << " ms, "
+		<< genetic_algorithm.worker_pool->number_of_failures << " worker failures, "
+		<< mismatches << " scores differ" << std::endl;
+	return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * least_squares.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_LEAST_SQUARES_HPP_
+#define SRC_LEAST_SQUARES_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "linear_model.hpp"
+
+namespace neural
+{
+
+enum class LeastSquaresSolver {
+	Cholesky,
+	LDLT
+};
+
+/* Normal Equations */
+
+// Running sums of XᵀX and Xᵀy over inputs augmented with a constant 1 for the bias.
+template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs>
+struct NormalEquations {
+	static constexpr int Size = NumInputs + 1;
+
+	using InputType     = Eigen::Matrix<ScalarType, NumInputs, 1>;
+	using OutputType    = Eigen::Matrix<ScalarType, NumOutputs, 1>;
+	using ParameterType = Eigen::Matrix<ScalarType, NumOutputs, NumInputs>;
+	using GramType      = Eigen::Matrix<ScalarType, Size, Size>;
+	using CrossType     = Eigen::Matrix<ScalarType, Size, NumOutputs>;
+
+	NormalEquations() { clear(); }
+
+	void clear() {
+		gram.setZero();
+		cross.setZero();
+		count = 0;
+	}
+
+	void add(const InputType& input, const OutputType& actual) {
+		Eigen::Matrix<ScalarType, Size, 1> z;
+		z << input, 1;
+		gram.noalias() += z * z.transpose();
+		cross.noalias() += z * actual.transpose();
+		++count;
+	}
+
+	// One sample per column. A block turns the rank one updates into a single matrix product.
+	template <typename InputBlock, typename OutputBlock>
+	void add_block(const Eigen::MatrixBase<InputBlock>& inputs, const Eigen::MatrixBase<OutputBlock>& actual) {
+		assert(inputs.rows() == NumInputs && actual.rows() == NumOutputs && inputs.cols() == actual.cols());
+		InputType input_sum = inputs.rowwise().sum();
+
+		gram.template topLeftCorner<NumInputs, NumInputs>().noalias() += inputs * inputs.transpose();
+		gram.template topRightCorner<NumInputs, 1>() += input_sum;
+		gram.template bottomLeftCorner<1, NumInputs>() += input_sum.transpose();
+		gram(NumInputs, NumInputs) += inputs.cols();
+
+		cross.template topRows<NumInputs>().noalias() += inputs * actual.transpose();
+		cross.row(NumInputs) += actual.rowwise().sum().transpose();
+		count += inputs.cols();
+	}
+
+	void merge(const NormalEquations& other) {
+		gram += other.gram;
+		cross += other.cross;
+		count += other.count;
+	}
+
+	// Solves (XᵀX + ridge I) w = Xᵀy. The bias is not regularized. Returns false if the system is singular.
+	bool solve(ParameterType& parameter, OutputType& bias, ScalarType ridge = 0, LeastSquaresSolver solver = LeastSquaresSolver::LDLT) const {
+		GramType A = gram;
+		A.diagonal().template head<NumInputs>().array() += ridge;
+
+		CrossType w;
+		if(solver == LeastSquaresSolver::Cholesky)
+		{
+			Eigen::LLT<GramType> llt(A);
+			if(llt.info() != Eigen::Success) return false;
+			w = llt.solve(cross);
+		}
+		else
+		{
+			Eigen::LDLT<GramType> ldlt(A);
+			if(ldlt.info() != Eigen::Success || !ldlt.isPositive()) return false;
+			w = ldlt.solve(cross);
+		}
+
+		parameter = w.template topRows<NumInputs>().transpose();
+		bias = w.row(NumInputs).transpose();
+		return true;
+	}
+
+	GramType gram;
+	CrossType cross;
+	size_t count;
+};
+
+// Streams once over a dataset stored one sample per column, block by block, split over number_of_threads threads.
+template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs>
+NormalEquations<ScalarType, NumInputs, NumOutputs> accumulate_normal_equations(
+	const Eigen::Matrix<ScalarType, NumInputs, Eigen::Dynamic>& inputs,
+	const Eigen::Matrix<ScalarType, NumOutputs, Eigen::Dynamic>& actual,
+	int number_of_threads = 1,
+	int block_size = 256)
+{
+	assert(inputs.cols() == actual.cols() && number_of_threads > 0 && block_size > 0);
+	using Equations = NormalEquations<ScalarType, NumInputs, NumOutputs>;
+
+	Eigen::Index n = inputs.cols();
+	std::vector<Equations> partial(number_of_threads);
+
+	auto accumulate = [&](int t) {
+		Eigen::Index begin = n*t/number_of_threads, end = n*(t+1)/number_of_threads;
+		for(Eigen::Index i = begin; i < end; i += block_size)
+		{
+			Eigen::Index len = std::min<Eigen::Index>(block_size, end-i);
+			partial[t].add_block(inputs.middleCols(i, len), actual.middleCols(i, len));
+		}
+	};
+
+	if(number_of_threads == 1) accumulate(0);
+	else
+	{
+		std::vector<std::thread> threads;
+		for(int t = 0; t < number_of_threads; ++t) threads.emplace_back(accumulate, t);
+		for(auto& thread : threads) thread.join();
+	}
+
+	for(int t = 1; t < number_of_threads; ++t) partial[0].merge(partial[t]);
+	return partial[0];
+}
+
+/* Normal Equation Linear Model */
+
+// train() only accumulates; call solve() when the model is needed. fit() does both for a whole dataset.
+template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs>
+struct NormalEquationLinearModel : public LinearModel<ScalarType, NumInputs, NumOutputs> {
+	using Base = LinearModel<ScalarType, NumInputs, NumOutputs>;
+	using typename Base::InputType;
+	using typename Base::OutputType;
+
+	NormalEquationLinearModel(ScalarType ridge_ = 0, LeastSquaresSolver solver_ = LeastSquaresSolver::LDLT)
+		: Base(), ridge{ridge_}, solver{solver_} {}
+
+	void train(const InputType& input, const OutputType& actual) override { equations.add(input, actual); }
+
+	bool solve() { return equations.solve(this->get_param(), this->get_bias(), ridge, solver); }
+
+	bool fit(const Eigen::Matrix<ScalarType, NumInputs, Eigen::Dynamic>& inputs,
+			 const Eigen::Matrix<ScalarType, NumOutputs, Eigen::Dynamic>& actual,
+			 int number_of_threads = 1)
+	{
+		equations.merge(accumulate_normal_equations<ScalarType, NumInputs, NumOutputs>(inputs, actual, number_of_threads));
+		return solve();
+	}
+
+	NormalEquations<ScalarType, NumInputs, NumOutputs> equations;
+	ScalarType ridge;
+	LeastSquaresSolver solver;
+};
+
+/* Recursive Least Squares Linear Model */
+
+// O(d²) exact online updates. The inverse Gram matrix starts at I/ridge, which
+// regularizes the bias as well, and forgetting < 1 discounts old samples.
+template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs>
+struct RecursiveLeastSquaresLinearModel : public LinearModel<ScalarType, NumInputs, NumOutputs> {
+	using Base = LinearModel<ScalarType, NumInputs, NumOutputs>;
+	using typename Base::InputType;
+	using typename Base::OutputType;
+
+	static constexpr int Size = NumInputs + 1;
+	using CovarianceType = Eigen::Matrix<ScalarType, Size, Size>;
+
+	RecursiveLeastSquaresLinearModel(ScalarType ridge = 1e-6, ScalarType forgetting_ = 1)
+		: Base(),
+		  covariance{CovarianceType::Identity()/ridge},
+		  forgetting{forgetting_}
+	{
+		assert(ridge > 0 && forgetting > 0 && forgetting <= 1);
+	}
+
+	void train(const InputType& input, const OutputType& actual) override
+	{
+		Eigen::Matrix<ScalarType, Size, 1> z;
+		z << input, 1;
+		Eigen::Matrix<ScalarType, Size, 1> Pz = covariance * z;
+		Eigen::Matrix<ScalarType, Size, 1> gain = Pz / (forgetting + z.dot(Pz));
+
+		OutputType error = actual - this->predict(input);
+		this->get_param().noalias() += error * gain.template head<NumInputs>().transpose();
+		this->get_bias() += error * gain(NumInputs);
+
+		covariance.noalias() -= gain * Pz.transpose();
+		if(forgetting < 1) covariance /= forgetting;
+	}
+
+	CovarianceType covariance;
+	ScalarType forgetting;
+};
+
+}
+
+#endif /* SRC_LEAST_SQUARES_HPP_ */
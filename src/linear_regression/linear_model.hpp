@@ -19,14 +19,16 @@ namespace neural
 template <typename ScalarType>
 struct LearningRate {
 	LearningRate(ScalarType r_) : rate{r_} {}
+	virtual ~LearningRate() = default;
 	virtual void update() = 0;
-	ScalarType get_rate() { return rate; }
-private :
+	ScalarType get_rate() const { return rate; }
+protected :
 	ScalarType rate;
 };
 
 template <typename ScalarType>
 struct ConstantLearningRate : public LearningRate<ScalarType> {
+	ConstantLearningRate(ScalarType r_) : LearningRate<ScalarType>(r_) {}
 	void update() override {};
 };
 
@@ -36,8 +38,8 @@ struct ExpLearningRate : public LearningRate<ScalarType> {
 		: LearningRate<ScalarType>(r_),
 		  decay{d_} {}
 
-	void update() {
-		rate *= decay;
+	void update() override {
+		this->rate *= decay;
 	}
 	
 	ScalarType decay;
@@ -57,38 +59,46 @@ struct LinearModel {
 		: parameter{parameter_},
 		  bias{bias_} {}
 	
-	OutputType predict(InputType& input) { return parameter * input + bias; }
+	virtual ~LinearModel() = default;
+	
+	OutputType predict(const InputType& input) const { return parameter * input + bias; }
 	ParameterType& get_param() { return parameter; }
+	const ParameterType& get_param() const { return parameter; }
 	OutputType& get_bias() { return bias; }
-	virtual void train(InputType&, OutputType&) = 0;
+	const OutputType& get_bias() const { return bias; }
+	virtual void train(const InputType&, const OutputType&) = 0;
 
 private :
 	ParameterType parameter;
 	OutputType bias;
 };
 
-template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs>
+template <typename ScalarType, unsigned int NumInputs, unsigned int NumOutputs, typename LearningRateType = ConstantLearningRate<ScalarType>>
 struct GradientDescentLinearModel : public LinearModel<ScalarType, NumInputs, NumOutputs> {
+	using Base = LinearModel<ScalarType, NumInputs, NumOutputs>;
+	using typename Base::InputType;
+	using typename Base::OutputType;
+	
 	GradientDescentLinearModel()
-		: LinearModel<ScalarType, NumInputs, NumOutputs>(), learning_rate{ConstantLearningRate(1)} {}
+		: Base(), learning_rate{1} {}
 	
-	GradientDescentLinearModel(LearningRate learn_)
-		: learning_rate {learn_} {}
+	GradientDescentLinearModel(LearningRateType learn_)
+		: Base(), learning_rate {learn_} {}
 	
-	void train(InputType& input, OutputType& actual) override
+	void train(const InputType& input, const OutputType& actual) override
 	{
-		auto error = predict(input) - actual;
-		get_param() -= learning_rate.get_rate() * error * input.transpose();
-		get_bias() -= learning_rate.get_rate() * error;
+		OutputType error = this->predict(input) - actual;
+		this->get_param() -= learning_rate.get_rate() * error * input.transpose();
+		this->get_bias() -= learning_rate.get_rate() * error;
 		learning_rate.update();
 	}
 	
-	LearningRate learning_rate;
+	LearningRateType learning_rate;
 };
 
 template <typename ModelType>
-void gradient_descent(double lambda, ModelType& model, typename ModelType::InputType& input, typename ModelType::OutputType& actual) {
-	auto error = model.predict(input) - actual;
+void gradient_descent(double lambda, ModelType& model, const typename ModelType::InputType& input, const typename ModelType::OutputType& actual) {
+	typename ModelType::OutputType error = model.predict(input) - actual;
 	model.get_param() -= lambda * error * input.transpose();
 	model.get_bias() -= lambda * error;
 }
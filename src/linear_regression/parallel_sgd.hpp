@@ -0,0 +1,148 @@
+/*
+ * parallel_sgd.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_PARALLEL_SGD_HPP_
+#define SRC_PARALLEL_SGD_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "linear_model.hpp"
+
+namespace neural
+{
+
+/*
+ *  Parallel stochastic gradient descent for linear models.
+ *
+ *  The dataset is stored one sample per column and split into one contiguous shard per
+ *  thread.
+ *
+ *  Hogwild  : every thread applies its updates straight to the shared parameters with
+ *             relaxed atomic loads and stores and no locks. Concurrent updates to the
+ *             same weight can overwrite each other, which costs little when updates are
+ *             small, but results depend on scheduling. The atomic accesses keep the
+ *             update from being vectorized, so Hogwild only pays off from a few threads.
+ *  Averaged : every thread runs SGD on a private copy for one epoch, then the copies are
+ *             averaged in thread order. Deterministic for a given number of threads.
+ */
+
+enum class ParallelSGDMode {
+	Hogwild,
+	Averaged
+};
+
+template <typename ModelType>
+using DatasetInputs = Eigen::Matrix<typename ModelType::InputType::Scalar, ModelType::InputType::RowsAtCompileTime, Eigen::Dynamic>;
+
+template <typename ModelType>
+using DatasetOutputs = Eigen::Matrix<typename ModelType::OutputType::Scalar, ModelType::OutputType::RowsAtCompileTime, Eigen::Dynamic>;
+
+namespace parallel_sgd_detail
+{
+
+// One SGD step on a shared model, through relaxed atomic accesses only.
+template <typename ParameterType, typename OutputType, typename InputColumn, typename OutputColumn>
+void hogwild_step(ParameterType& parameter, OutputType& bias, const InputColumn& input, const OutputColumn& actual, typename OutputType::Scalar lambda)
+{
+	using Scalar = typename OutputType::Scalar;
+	constexpr int Rows = ParameterType::RowsAtCompileTime;
+	constexpr int Cols = ParameterType::ColsAtCompileTime;
+	auto load  = [](Scalar* x) { return std::atomic_ref<Scalar>(*x).load(std::memory_order_relaxed); };
+	auto store = [](Scalar* x, Scalar v) { std::atomic_ref<Scalar>(*x).store(v, std::memory_order_relaxed); };
+
+	Scalar* w = parameter.data();
+	Scalar* b = bias.data();
+	Scalar error[Rows];
+	for(int r = 0; r < Rows; ++r) error[r] = load(b+r) - actual(r);
+	for(int c = 0; c < Cols; ++c)
+		for(int r = 0; r < Rows; ++r)
+			error[r] += load(w + c*Rows + r) * input(c);
+
+	for(int r = 0; r < Rows; ++r) error[r] *= lambda;
+	for(int c = 0; c < Cols; ++c)
+		for(int r = 0; r < Rows; ++r)
+			store(w + c*Rows + r, load(w + c*Rows + r) - error[r] * input(c));
+	for(int r = 0; r < Rows; ++r)
+		store(b+r, load(b+r) - error[r]);
+}
+
+}
+
+template <typename ModelType>
+void parallel_sgd(ModelType& model,
+				  const DatasetInputs<ModelType>& inputs,
+				  const DatasetOutputs<ModelType>& actual,
+				  double lambda,
+				  int epochs,
+				  int number_of_threads,
+				  ParallelSGDMode mode = ParallelSGDMode::Hogwild)
+{
+	using ParameterType = typename ModelType::ParameterType;
+	using OutputType    = typename ModelType::OutputType;
+	using Scalar        = typename OutputType::Scalar;
+
+	assert(inputs.cols() == actual.cols() && number_of_threads > 0);
+	Eigen::Index n = inputs.cols();
+	auto shard_begin = [n, number_of_threads](int t) { return n*t/number_of_threads; };
+
+	std::vector<ParameterType> parameters(number_of_threads);
+	std::vector<OutputType> biases(number_of_threads);
+
+	auto worker = [&](int t) {
+		if(mode == ParallelSGDMode::Hogwild)
+		{
+			for(Eigen::Index i = shard_begin(t); i < shard_begin(t+1); ++i)
+				parallel_sgd_detail::hogwild_step(model.get_param(), model.get_bias(), inputs.col(i), actual.col(i), (Scalar)lambda);
+		}
+		else
+		{
+			parameters[t] = model.get_param();
+			biases[t] = model.get_bias();
+			for(Eigen::Index i = shard_begin(t); i < shard_begin(t+1); ++i)
+			{
+				OutputType error = parameters[t] * inputs.col(i) + biases[t] - actual.col(i);
+				parameters[t].noalias() -= lambda * error * inputs.col(i).transpose();
+				biases[t] -= lambda * error;
+			}
+		}
+	};
+
+	for(int epoch = 0; epoch < epochs; ++epoch)
+	{
+		std::vector<std::thread> threads;
+		for(int t = 1; t < number_of_threads; ++t) threads.emplace_back(worker, t);
+		worker(0);
+		for(auto& thread : threads) thread.join();
+
+		if(mode == ParallelSGDMode::Averaged)
+		{
+			for(int t = 1; t < number_of_threads; ++t)
+			{
+				parameters[0] += parameters[t];
+				biases[0] += biases[t];
+			}
+			model.get_param() = parameters[0] / number_of_threads;
+			model.get_bias() = biases[0] / number_of_threads;
+		}
+	}
+}
+
+// Mean squared error of the model over a dataset.
+template <typename ModelType>
+double mean_squared_error(const ModelType& model, const DatasetInputs<ModelType>& inputs, const DatasetOutputs<ModelType>& actual)
+{
+	return ((model.get_param() * inputs).colwise() + model.get_bias() - actual).squaredNorm() / inputs.cols();
+}
+
+}
+
+#endif /* SRC_PARALLEL_SGD_HPP_ */
@@ -0,0 +1,152 @@
+/*
+ * sparse_linear_model.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_SPARSE_LINEAR_MODEL_HPP_
+#define SRC_SPARSE_LINEAR_MODEL_HPP_
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <tuple>
+#include <vector>
+
+#include "linear_model.hpp"
+
+namespace neural
+{
+
+/*
+ *  Sparse-input linear models.
+ *
+ *  For very high dimensional inputs with few non-zeros, e.g. hashed features. The number
+ *  of inputs is only known at runtime and prediction and training cost O(nnz). Inputs are
+ *  index/value pairs, an Eigen::SparseVector, or a row of a row-major (CSR)
+ *  Eigen::SparseMatrix dataset.
+ *
+ *  The indexing policy maps an input index to a weight column:
+ *      DenseIndexing  : one column per input, number_of_slots is the input dimension.
+ *      HashedIndexing : indices are hashed into number_of_slots columns (a power of two),
+ *                       so memory is fixed whatever the range of the indices.
+ */
+
+struct DenseIndexing {
+	static size_t slot(uint64_t index, size_t number_of_slots) {
+		assert(index < number_of_slots);
+		return index;
+	}
+};
+
+struct HashedIndexing {
+	static size_t slot(uint64_t index, size_t number_of_slots) {
+		assert((number_of_slots & (number_of_slots-1)) == 0);
+		// splitmix64 finalizer.
+		index ^= index >> 30; index *= 0xbf58476d1ce4e5b9ULL;
+		index ^= index >> 27; index *= 0x94d049bb133111ebULL;
+		index ^= index >> 31;
+		return index & (number_of_slots-1);
+	}
+};
+
+template <typename ScalarType>
+using SparseSample = std::vector<std::pair<uint64_t, ScalarType>>;
+
+template <typename ScalarType, unsigned int NumOutputs, typename Indexing = DenseIndexing, typename LearningRateType = ConstantLearningRate<ScalarType>>
+struct SparseLinearModel {
+	using ParameterType = Eigen::Matrix<ScalarType, NumOutputs, Eigen::Dynamic>;
+	using OutputType    = Eigen::Matrix<ScalarType, NumOutputs, 1>;
+	using DatasetType   = Eigen::SparseMatrix<ScalarType, Eigen::RowMajor>;
+
+	SparseLinearModel(size_t number_of_slots, LearningRateType learn_ = LearningRateType(1))
+		: parameter{ParameterType::Zero(NumOutputs, number_of_slots)},
+		  bias{OutputType::Zero()},
+		  learning_rate{learn_} {}
+
+	/* Prediction */
+
+	template <typename IndexType>
+	OutputType predict(const IndexType* indices, const ScalarType* values, size_t nnz) const {
+		OutputType res = bias;
+		for(size_t k = 0; k < nnz; ++k) res += values[k] * parameter.col(slot(indices[k]));
+		return res;
+	}
+
+	OutputType predict(const SparseSample<ScalarType>& input) const {
+		OutputType res = bias;
+		for(const auto& [index, value] : input) res += value * parameter.col(slot(index));
+		return res;
+	}
+
+	OutputType predict(const Eigen::SparseVector<ScalarType>& input) const {
+		return predict(input.innerIndexPtr(), input.valuePtr(), input.nonZeros());
+	}
+
+	OutputType predict(const DatasetType& inputs, Eigen::Index row) const {
+		auto [indices, values, nnz] = row_of(inputs, row);
+		return predict(indices, values, nnz);
+	}
+
+	/* Training */
+
+	// One SGD step on squared error, touching only the columns of the non-zero inputs.
+	template <typename IndexType>
+	void train(const IndexType* indices, const ScalarType* values, size_t nnz, const OutputType& actual) {
+		OutputType step = learning_rate.get_rate() * (predict(indices, values, nnz) - actual);
+		for(size_t k = 0; k < nnz; ++k) parameter.col(slot(indices[k])) -= values[k] * step;
+		bias -= step;
+		learning_rate.update();
+	}
+
+	void train(const SparseSample<ScalarType>& input, const OutputType& actual) {
+		OutputType step = learning_rate.get_rate() * (predict(input) - actual);
+		for(const auto& [index, value] : input) parameter.col(slot(index)) -= value * step;
+		bias -= step;
+		learning_rate.update();
+	}
+
+	void train(const Eigen::SparseVector<ScalarType>& input, const OutputType& actual) {
+		train(input.innerIndexPtr(), input.valuePtr(), input.nonZeros(), actual);
+	}
+
+	// Epochs of SGD over a CSR dataset, one sample per row.
+	void train(const DatasetType& inputs, const Eigen::Matrix<ScalarType, NumOutputs, Eigen::Dynamic>& actual, int epochs = 1) {
+		assert(inputs.isCompressed() && inputs.rows() == actual.cols());
+		for(int epoch = 0; epoch < epochs; ++epoch)
+			for(Eigen::Index i = 0; i < inputs.rows(); ++i)
+			{
+				auto [indices, values, nnz] = row_of(inputs, i);
+				train(indices, values, nnz, actual.col(i));
+			}
+	}
+
+	ParameterType& get_param() { return parameter; }
+	const ParameterType& get_param() const { return parameter; }
+	OutputType& get_bias() { return bias; }
+	const OutputType& get_bias() const { return bias; }
+	size_t number_of_slots() const { return parameter.cols(); }
+
+private :
+	size_t slot(uint64_t index) const { return Indexing::slot(index, parameter.cols()); }
+
+	static std::tuple<const typename DatasetType::StorageIndex*, const ScalarType*, size_t> row_of(const DatasetType& inputs, Eigen::Index row) {
+		auto begin = inputs.outerIndexPtr()[row], end = inputs.outerIndexPtr()[row+1];
+		return {inputs.innerIndexPtr() + begin, inputs.valuePtr() + begin, (size_t)(end - begin)};
+	}
+
+	ParameterType parameter;
+	OutputType bias;
+	LearningRateType learning_rate;
+};
+
+template <typename ScalarType, unsigned int NumOutputs, typename LearningRateType = ConstantLearningRate<ScalarType>>
+using HashedLinearModel = SparseLinearModel<ScalarType, NumOutputs, HashedIndexing, LearningRateType>;
+
+}
+
+#endif /* SRC_SPARSE_LINEAR_MODEL_HPP_ */
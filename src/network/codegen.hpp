@@ -0,0 +1,168 @@
+/*
+ * codegen.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_CODEGEN_HPP_
+#define SRC_CODEGEN_HPP_
+
+#include <cmath>
+#include <cctype>
+#include <cassert>
+#include <string>
+#include <ostream>
+#include <iostream>
+#include <iterator>
+#include <ios>
+#include <algorithm>
+#include <type_traits>
+
+#include "layer.hpp"
+
+namespace neural
+{
+
+/*
+ *  Code generation.
+ *
+ *  Writes a trained network as a standalone C++ header for deployment. The header needs
+ *  only <cmath>: the weights are constexpr arrays, aligned to 64 bytes, and
+ *
+ *  	void name::feed_forward(const scalar* input, scalar* output)
+ *
+ *  is the forward pass written out statement by statement for the exact shapes and
+ *  activations, so the compiler sees every weight as a constant and nothing is read at
+ *  startup. Written-out code grows with the number of weights; past unroll_limit
+ *  weights a layer is a pair of loops with constant bounds instead. On a 16-128-64-2
+ *  network, writing out every layer was slower than stopping at the default.
+ *
+ *  The sums are not added in the order Eigen adds them, so outputs agree with
+ *  NeuralNetwork::feed_forward to rounding, not bit for bit. src/examples/codegen
+ *  checks that they do.
+ */
+
+struct CodegenOptions {
+	size_t unroll_limit = 4096;		// Largest layer, in weights, written out in full.
+};
+
+namespace codegen_detail
+{
+	// True when name can be the namespace of the generated code.
+	inline bool is_identifier(const std::string& name)
+	{
+		static const char* keywords[] = {"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+			"case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+			"constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete", "do", "double",
+			"dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline",
+			"int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private",
+			"protected", "public", "register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+			"static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef",
+			"typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"};
+		if(name.empty() || std::isdigit((unsigned char)name[0])) return false;
+		if(!std::all_of(name.begin(), name.end(), [](unsigned char c) { return std::isalnum(c) || c == '_'; })) return false;
+		return std::none_of(std::begin(keywords), std::end(keywords), [&name](const char* k) { return name == k; });
+	}
+
+	inline const char* activation_code(ActivationType a)
+	{
+		switch(a)
+		{
+			case ActivationType::Sigmoid : return "sigmoid";
+			case ActivationType::Tanh : return "tanh_";
+			case ActivationType::ReLU : return "relu";
+		}
+		return "";
+	}
+}
+
+// Writes nothing and returns false when name is not a C++ identifier.
+template <typename Scalar>
+bool generate_code(std::ostream& out, const DynamicNeuralNetwork<Scalar>& nn, const std::string& name, CodegenOptions options = {})
+{
+	assert(nn.number_of_layers() > 0);
+	static_assert(std::is_same_v<Scalar, float> || std::is_same_v<Scalar, double>);
+	if(!codegen_detail::is_identifier(name))
+	{
+		std::cout << "generate_code: " << name << " is not a C++ identifier" << std::endl;
+		return false;
+	}
+	const char* scalar = std::is_same_v<Scalar, float> ? "float" : "double";
+	const char* suffix = std::is_same_v<Scalar, float> ? "f" : "";
+	std::string guard = name;
+	std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) { return std::toupper(c); });
+	guard += "_HPP_";
+
+	out << "/*\n * " << name << ".hpp\n *\n *  Generated by neural codegen. Do not edit.\n *\n *  layers:";
+	for(size_t l = 0; l < nn.layers.size(); ++l)
+		out << (l ? "; " : " ") << nn.layers[l].inputs() << " " << nn.layers[l].outputs() << " " << activation_name(nn.layers[l].get_activation());
+	out << "\n */\n\n#ifndef " << guard << "\n#define " << guard << "\n\n#include <cmath>\n\nnamespace " << name << "\n{\n\n";
+	out << "using scalar = " << scalar << ";\n\n";
+	out << "constexpr int input_size  = " << nn.input_size() << ";\n";
+	out << "constexpr int output_size = " << nn.output_size() << ";\n\n";
+
+	// The same functions as math_functions.hpp.
+	out << "inline scalar sigmoid(scalar x) { return 1.0 / (1.0 + std::exp(-x)); }\n";
+	out << "inline scalar tanh_(scalar x) { return std::tanh(x); }\n";
+	out << "inline scalar relu(scalar x) { return (x>0) ? x : 0; }\n\n";
+
+	// Weights column by column, as Eigen keeps them, so w[c] is what input c adds to every
+	// output. Hexadecimal literals are exact.
+	auto flags = out.flags();
+	out << std::hexfloat;
+	for(size_t l = 0; l < nn.layers.size(); ++l)
+	{
+		const auto& w = nn.layers[l].get_weight();
+		out << "alignas(64) constexpr scalar w" << l << "[" << w.cols() << "][" << w.rows() << "] = {\n";
+		for(int c = 0; c < w.cols(); ++c)
+		{
+			out << "\t{";
+			for(int r = 0; r < w.rows(); ++r) out << (r ? ", " : "") << w(r, c) << suffix;
+			out << "},\n";
+		}
+		out << "};\n\n";
+	}
+	out.flags(flags);
+
+	// Every layer adds the column of each input to all of its outputs at once, which
+	// vectorizes over the outputs without reordering any sum.
+	out << "inline void feed_forward(const scalar* input, scalar* output)\n{\n";
+	for(size_t l = 0; l < nn.layers.size(); ++l)
+	{
+		const auto& layer = nn.layers[l];
+		const int rows = layer.outputs(), cols = layer.inputs();
+		const std::string x = l ? std::string("a") + std::to_string(l-1) : std::string("input");
+		const std::string y = std::string("a") + std::to_string(l);
+		const std::string w = std::string("w") + std::to_string(l);
+		const char* f = codegen_detail::activation_code(layer.get_activation());
+		out << "\talignas(64) scalar " << y << "[" << rows << "];\n";
+		if((size_t)layer.get_weight().size() <= options.unroll_limit)
+		{
+			for(int c = 0; c < cols; ++c)
+				for(int r = 0; r < rows; ++r)
+				{
+					out << "\t" << y << "[" << r << "] " << (c ? "+= " : "= ") << w << "[" << c << "][" << r << "]*" << x << "[" << c << "];\n";
+				}
+		}
+		else
+		{
+			out << "\tfor(int r = 0; r < " << rows << "; ++r) " << y << "[r] = " << w << "[0][r]*" << x << "[0];\n";
+			out << "\tfor(int c = 1; c < " << cols << "; ++c)\n";
+			out << "\t\tfor(int r = 0; r < " << rows << "; ++r) " << y << "[r] += " << w << "[c][r]*" << x << "[c];\n";
+		}
+		out << "\tfor(int r = 0; r < " << rows << "; ++r) " << (l + 1 == nn.layers.size() ? "output" : y) << "[r] = " << f << "(" << y << "[r]);\n";
+	}
+	out << "}\n\n}\n\n#endif /* " << guard << " */\n";
+	return true;
+}
+
+template <typename... Layers>
+bool generate_code(std::ostream& out, const NeuralNetwork<Layers...>& nn, const std::string& name, CodegenOptions options = {})
+{
+	return generate_code(out, DynamicNeuralNetwork<typename NeuralNetwork<Layers...>::ScalarType>(nn), name, options);
+}
+
+}
+
+#endif /* SRC_CODEGEN_HPP_ */
@@ -32,6 +32,18 @@ template <typename T> 	constexpr bool is_layer = false;
 
 template <class T> concept layer_type = is_layer<T>;
 
+/* Recurrent Layers */
+// A recurrent layer has a StateType, the hidden state it carries from one step to the
+// next, see recurrent_layer.hpp. Every other layer has NoState.
+struct NoState {};
+
+template <class T> concept recurrent_layer_type = requires { typename T::StateType; };
+
+template <typename T> 				struct layer_state		{ using type = NoState; };
+template <recurrent_layer_type T>	struct layer_state<T> 	{ using type = typename T::StateType; };
+
+template <typename T> using layer_state_t = typename layer_state<T>::type;
+
 }
 
 #endif /* SRC_CONCEPTS_HPP_ */
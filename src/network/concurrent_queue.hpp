@@ -0,0 +1,87 @@
+/*
+ * concurrent_queue.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_CONCURRENT_QUEUE_HPP_
+#define SRC_CONCURRENT_QUEUE_HPP_
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace neural
+{
+
+/*
+ *  Concurrent queue.
+ *
+ *  A first in, first out queue for any number of producers and consumers. pop() waits
+ *  for an element; after close() it returns the elements left and then false, so the
+ *  consumers drain the queue and stop.
+ */
+
+template <typename T>
+class ConcurrentQueue
+{
+public :
+	void push(T value)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(closed) return;
+			queue.push_back(std::move(value));
+		}
+		ready.notify_one();
+	}
+
+	// Waits for an element. Returns false once the queue is closed and empty.
+	bool pop(T& value)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		ready.wait(lock, [this]() { return closed || !queue.empty(); });
+		if(queue.empty()) return false;
+		value = std::move(queue.front());
+		queue.pop_front();
+		return true;
+	}
+
+	bool try_pop(T& value)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(queue.empty()) return false;
+		value = std::move(queue.front());
+		queue.pop_front();
+		return true;
+	}
+
+	// Stops accepting elements and wakes every consumer. With discard, the elements left are dropped.
+	void close(bool discard = false)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+			if(discard) queue.clear();
+		}
+		ready.notify_all();
+	}
+
+	size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return queue.size();
+	}
+
+private :
+	mutable std::mutex mutex;
+	std::condition_variable ready;
+	std::deque<T> queue;
+	bool closed = false;
+};
+
+}
+
+#endif /* SRC_CONCURRENT_QUEUE_HPP_ */
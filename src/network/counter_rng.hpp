@@ -0,0 +1,112 @@
+/*
+ * counter_rng.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_COUNTER_RNG_HPP_
+#define SRC_COUNTER_RNG_HPP_
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <cassert>
+
+namespace neural
+{
+
+/*
+ *  Counter-based random numbers.
+ *
+ *  Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3") maps a
+ *  128 bit counter and a 64 bit key to 128 random bits, with no state in between. The
+ *  key is the seed and the counter names the draw:
+ *
+ *      word 0 : element, the index of the weight in its layer
+ *      word 1 : individual
+ *      word 2 : generation
+ *      word 3 : stream (what the number is for) << 16 | layer
+ *
+ *  The same draw always returns the same number, so weights can be filled in any order,
+ *  by any number of threads, with bit-identical results.
+ */
+
+enum class RandomStream : uint32_t {
+	Initialization,
+	Mutation,
+	Crossover,
+	Selection,
+	Perturbation,
+	Projection
+};
+
+struct Philox4x32 {
+	using CounterType = std::array<uint32_t, 4>;
+	using KeyType     = std::array<uint32_t, 2>;
+
+	static CounterType generate(CounterType c, KeyType k)
+	{
+		for(int round = 0; round < 10; ++round)
+		{
+			uint64_t p0 = (uint64_t)0xD2511F53 * c[0];
+			uint64_t p1 = (uint64_t)0xCD9E8D57 * c[2];
+			c = {(uint32_t)(p1 >> 32) ^ c[1] ^ k[0], (uint32_t)p1,
+				 (uint32_t)(p0 >> 32) ^ c[3] ^ k[1], (uint32_t)p0};
+			k[0] += 0x9E3779B9;
+			k[1] += 0xBB67AE85;
+		}
+		return c;
+	}
+};
+
+class CounterRNG
+{
+public :
+	CounterRNG(uint64_t seed_ = 0) : seed{seed_} {}
+
+	// The stream and the layer share a word, so layer is below 65536.
+	Philox4x32::CounterType bits(RandomStream stream, uint32_t generation, uint32_t individual, uint32_t layer, uint32_t element) const
+	{
+		assert(layer < 0x10000);
+		return Philox4x32::generate({element, individual, generation, ((uint32_t)stream << 16) | (layer & 0xFFFF)},
+									{(uint32_t)seed, (uint32_t)(seed >> 32)});
+	}
+
+	// Uniform on [0, 1) with 53 random bits.
+	double uniform(RandomStream stream, uint32_t generation, uint32_t individual, uint32_t layer, uint32_t element) const
+	{
+		auto r = bits(stream, generation, individual, layer, element);
+		return to_unit(r[0], r[1]);
+	}
+
+	// Standard normal by Box-Muller, one per counter.
+	double normal(RandomStream stream, uint32_t generation, uint32_t individual, uint32_t layer, uint32_t element) const
+	{
+		auto r = bits(stream, generation, individual, layer, element);
+		double u1 = 1.0 - to_unit(r[0], r[1]);	// (0, 1], so the log is finite.
+		double u2 = to_unit(r[2], r[3]);
+		return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+	}
+
+	// One random bit, 128 elements per counter.
+	bool bit(RandomStream stream, uint32_t generation, uint32_t individual, uint32_t layer, uint32_t element) const
+	{
+		auto r = bits(stream, generation, individual, layer, element / 128);
+		return (r[(element % 128) / 32] >> (element % 32)) & 1;
+	}
+
+	uint64_t get_seed() const { return seed; }
+
+private :
+	static double to_unit(uint32_t lo, uint32_t hi)
+	{
+		return ((((uint64_t)hi << 32) | lo) >> 11) * 0x1.0p-53;
+	}
+
+	uint64_t seed;
+};
+
+}
+
+#endif /* SRC_COUNTER_RNG_HPP_ */
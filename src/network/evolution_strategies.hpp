@@ -0,0 +1,243 @@
+/*
+ * evolution_strategies.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_EVOLUTION_STRATEGIES_HPP_
+#define SRC_EVOLUTION_STRATEGIES_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <utility>
+
+#include "plain_neural_network.hpp"
+#include "counter_rng.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+
+namespace neural
+{
+
+/*
+ *  Evolution strategies (Salimans et al., "Evolution Strategies as a Scalable Alternative
+ *  to Reinforcement Learning").
+ *
+ *  A single network is the center of a Gaussian search distribution. Every generation,
+ *  pair i is scored at center + sigma eps_i and center - sigma eps_i (antithetic
+ *  sampling), where eps_i is drawn from the counter RNG keyed by (generation, i). The
+ *  2n scores are replaced by centered ranks in [-0.5, 0.5], and the center moves along
+ *
+ *      g = 1/(2 n sigma) sum_i (u_i+ - u_i-) eps_i
+ *
+ *  with momentum. Because eps_i is regenerated from (generation, i), an evaluation is fully
+ *  described by an EvaluationResult {pair, plus, minus}. Workers, threads here or other
+ *  processes, only send those back and never a vector of parameters.
+ *
+ *  ScorerT is the GeneticAlgorithm scorer: compare(a, b) is true when a is better. Every
+ *  evaluator thread uses its own copy of the scorer.
+ */
+
+// True if any layer of NN stores its weights narrower than it computes, see perceptron_layer.hpp.
+template <typename NN>
+constexpr bool has_compressed_layers = []<size_t... N>(std::index_sequence<N...>) {
+	auto compressed = []<typename LayerT>(LayerT*) {
+		if constexpr (requires { LayerT::Compressed; }) return LayerT::Compressed;
+		else return false;
+	};
+	return (compressed((typename NN::template LayerType<N>*)nullptr) || ...);
+}(std::make_index_sequence<NN::number_of_layers>{});
+
+template <typename ScorerT, typename NN>
+class EvolutionStrategies
+{
+public :
+	using NetworkType = NN;
+	using ScoreType   = typename ScorerT::OutputType;
+
+	// An update of learning_rate times the gradient is far below the resolution of a
+	// bfloat16 or half weight and rounds away.
+	static_assert(!has_compressed_layers<NN>, "EvolutionStrategies needs full precision weights");
+
+	struct EvaluationResult {
+		uint32_t pair;
+		ScoreType plus;
+		ScoreType minus;
+	};
+
+	EvolutionStrategies(unsigned int number_of_pairs_, double sigma_ = 0.05, double learning_rate_ = 0.01, uint64_t seed = 0)
+		: number_of_pairs{number_of_pairs_}
+		, sigma{sigma_}
+		, learning_rate{learning_rate_}
+		, rng{seed}
+	{
+		static_assert(std::is_same_v<typename ScorerT::InputType, NetworkType>);
+		assert(number_of_pairs >= 1);
+		for_each_layer(network, [this](size_t, const auto& layer) { number_of_parameters += layer.get_weight().size(); });
+		velocity = Eigen::VectorXd::Zero(number_of_parameters);
+	}
+
+	template <typename Initializer>
+	void initialize(const Initializer& init) { network.initialize(init, 0u); }
+
+	/* Perturbations */
+
+	// center + sign sigma eps_pair, regenerated from the counter RNG.
+	void perturbed(uint32_t pair, int sign, NetworkType& candidate) const
+	{
+		candidate = network;
+		for_each_layer(candidate, [this, pair, sign](size_t l, auto& layer) {
+			auto& w = layer.get_weight();
+			for(int k = 0; k < w.size(); ++k)
+				w.data()[k] += sign * sigma * rng.normal(RandomStream::Perturbation, generation, pair, l, k);
+		});
+	}
+
+	EvaluationResult evaluate(uint32_t pair, ScorerT& local_scorer) const
+	{
+		ProfileScope scope(ProfilePhase::Evaluation);
+		TraceSpan span("evaluate pair", "es", "pair", pair);
+		NetworkType candidate;
+		perturbed(pair, +1, candidate);
+		ScoreType plus = local_scorer(candidate);
+		perturbed(pair, -1, candidate);
+		ScoreType minus = local_scorer(candidate);
+		return {pair, plus, minus};
+	}
+
+	// Scores every pair of this generation on number_of_threads threads. Pairs are handed
+	// out one at a time, so slow episodes do not hold up a whole block.
+	std::vector<EvaluationResult> evaluate_all()
+	{
+		TraceSpan span("evaluate_all", "es", "pairs", number_of_pairs);
+		std::vector<EvaluationResult> results(number_of_pairs);
+		std::atomic<uint32_t> next {0};
+
+		auto worker = [this, &results, &next]() {
+			ScorerT local_scorer = scorer;
+			for(uint32_t pair = next++; pair < number_of_pairs; pair = next++)
+				results[pair] = evaluate(pair, local_scorer);
+		};
+
+		int threads_used = std::max(1, std::min<int>(number_of_threads, number_of_pairs));
+		std::vector<std::thread> threads;
+		for(int t = 1; t < threads_used; ++t) threads.emplace_back(worker);
+		worker();
+		for(auto& thread : threads) thread.join();
+		return results;
+	}
+
+	/* Update */
+
+	// Moves the center with the results of this generation and starts the next one.
+	// The results may come in any order, from anywhere; they are sorted by pair first.
+	void apply(std::vector<EvaluationResult> results)
+	{
+		TraceSpan span("apply", "es", "pairs", results.size());
+		assert(!results.empty());
+		std::sort(results.begin(), results.end(), [](const EvaluationResult& a, const EvaluationResult& b) { return a.pair < b.pair; });
+		size_t n = results.size();
+
+		// Centered ranks: the best of the 2n scores gets 0.5, the worst -0.5.
+		std::vector<ScoreType> scores(2*n);
+		for(size_t i = 0; i < n; ++i)
+		{
+			scores[2*i] = results[i].plus;
+			scores[2*i+1] = results[i].minus;
+		}
+		std::vector<size_t> order(2*n);
+		std::iota(order.begin(), order.end(), 0);
+		{
+			ProfileScope scope(ProfilePhase::Sort);
+			std::stable_sort(order.begin(), order.end(), [this, &scores](size_t a, size_t b) { return scorer.compare(scores[a], scores[b]); });
+		}
+		// Tied scores share the mean of their ranks, so a generation where every score is the same does not move the center.
+		std::vector<double> utility(2*n, 0);
+		for(size_t first = 0, last; first < 2*n; first = last)
+		{
+			for(last = first+1; last < 2*n && !scorer.compare(scores[order[first]], scores[order[last]]); ++last);
+			double rank = 0.5*(first + last - 1);
+			for(size_t r = first; r < last; ++r)
+				utility[order[r]] = (2*n > 1) ? 0.5 - rank/(2*n-1) : 0;
+		}
+
+		// The gradient is summed in fixed blocks of pairs, then the blocks in order, so it
+		// does not depend on the number of threads.
+		constexpr size_t block_size = 16;
+		size_t number_of_blocks = (n + block_size - 1)/block_size;
+		std::vector<Eigen::VectorXd> partial(number_of_blocks, Eigen::VectorXd::Zero(number_of_parameters));
+		std::atomic<size_t> next {0};
+
+		auto worker = [&]() {
+			for(size_t b = next++; b < number_of_blocks; b = next++)
+				for(size_t i = b*block_size; i < std::min(n, (b+1)*block_size); ++i)
+				{
+					double weight = utility[2*i] - utility[2*i+1];
+					size_t offset = 0;
+					for_each_layer(network, [&](size_t l, const auto& layer) {
+						for(int k = 0; k < layer.get_weight().size(); ++k)
+							partial[b](offset + k) += weight * rng.normal(RandomStream::Perturbation, generation, results[i].pair, l, k);
+						offset += layer.get_weight().size();
+					});
+				}
+		};
+
+		int threads_used = std::max(1, std::min<int>(number_of_threads, number_of_blocks));
+		std::vector<std::thread> threads;
+		for(int t = 1; t < threads_used; ++t) threads.emplace_back(worker);
+		worker();
+		for(auto& thread : threads) thread.join();
+
+		Eigen::VectorXd gradient = Eigen::VectorXd::Zero(number_of_parameters);
+		for(const auto& p : partial) gradient += p;
+		gradient /= 2*n*sigma;
+
+		velocity = momentum * velocity + gradient;
+		size_t offset = 0;
+		for_each_layer(network, [&](size_t, auto& layer) {
+			auto& w = layer.get_weight();
+			for(int k = 0; k < w.size(); ++k)
+				w.data()[k] += learning_rate * velocity(offset + k) - learning_rate * weight_decay * w.data()[k];
+			offset += w.size();
+		});
+
+		best_score = scores[order[0]];
+		++generation;
+	}
+
+	// One generation: evaluate every pair, then update the center.
+	void step()
+	{
+		TraceSpan span("es step", "es");
+		apply(evaluate_all());
+	}
+
+public :
+	NetworkType network;
+	ScorerT scorer;
+	unsigned int number_of_pairs;
+	double sigma;
+	double learning_rate;
+	double momentum = 0.9;
+	double weight_decay = 0;
+	int number_of_threads = 1;
+	uint32_t generation = 0;
+	ScoreType best_score {};
+
+private :
+	CounterRNG rng;
+	size_t number_of_parameters = 0;
+	Eigen::VectorXd velocity;
+};
+
+}
+
+#endif /* SRC_EVOLUTION_STRATEGIES_HPP_ */
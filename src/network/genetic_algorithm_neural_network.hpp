@@ -13,9 +13,20 @@
 #include <tuple>
 #include <cassert>
 
-#include <random>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <limits>
+#include <type_traits>
 
 #include "plain_neural_network.hpp"
+#include "genome.hpp"
+#include "counter_rng.hpp"
+#include "process_pool.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
 
 
 
@@ -38,7 +49,8 @@ public :
 	using ScalarType = LayerType<0>::ScalarType;
 	
 	using NetworkType    = NN;
-	using PopulationType = std::pair < NetworkType, typename ScorerT::OutputType>;
+	using GenomeType     = Genome<NetworkType>;
+	using PopulationType = std::pair < GenomeType, typename ScorerT::OutputType>;
 	
 public :
 	GeneticAlgorithm(unsigned int population_size_)
@@ -48,81 +60,108 @@ public :
 		static_assert(std::is_same_v<typename ScorerT::InputType, NetworkType>);
 	}
 	
-	/* Feed Forward Algorithm */
+	/* Initialization */
 
 public :
+	// Keyed initializers (see initialization.hpp) fill the population in parallel.
 	template <typename Initializer>
 	void initialize(Initializer& init)
 	{
-		for (auto& nn : population) nn.first.initialize(init);
+		if constexpr (requires(const Initializer& i, NetworkType& nn) { nn.initialize(i, 0u); })
+			parallel_for(population_size, [this, &init](size_t i) { population[i].first.write().initialize(init, (uint32_t)i); });
+		else
+			for (auto& nn : population) nn.first.write().initialize(init);
 	}
 	
 	/* Crossover Functions */
 	
+	// Every weight comes from one parent for child1 and from the other for child2, by a
+	// random bit keyed by (generation, pair, layer, weight).
 	template <int N>
-	void get_child_of_layer(const LayerType<N>& layer1, const LayerType<N>& layer2, LayerType<N>& child1, LayerType<N>& child2)
+	void get_child_of_layer(const LayerType<N>& layer1, const LayerType<N>& layer2, LayerType<N>& child1, LayerType<N>& child2, uint32_t pair)
 	{
-		std::uniform_int_distribution dist(0,1);
+		const auto& w1 = layer1.get_weight();
+		const auto& w2 = layer2.get_weight();
+		auto& c1 = child1.get_weight();
+		auto& c2 = child2.get_weight();
 		
-		for(int i = 0; i < LayerType<N>::OutputSize; ++i)
+		for(int k = 0; k < w1.size(); ++k)
 		{
-			for(int j = 0; j < LayerType<N>::InputSize; ++j)
-			{
-				if(dist(gen))
-				{
-					child1.get_weight()(i,j) = layer1.get_weight()(i,j);
-					child2.get_weight()(i,j) = layer2.get_weight()(i,j);
-				}
-				else
-				{
-					child1.get_weight()(i,j) = layer2.get_weight()(i,j);
-					child2.get_weight()(i,j) = layer1.get_weight()(i,j);
-				}
-			}
+			bool first = rng.bit(RandomStream::Crossover, generation, pair, N, k);
+			c1.data()[k] = first ? w1.data()[k] : w2.data()[k];
+			c2.data()[k] = first ? w2.data()[k] : w1.data()[k];
 		}
 	}
 	
 	template <int N>
-	void get_child(const NetworkType& nn1, const NetworkType& nn2, NetworkType& nn_child1, NetworkType& nn_child2)
+	void get_child(const NetworkType& nn1, const NetworkType& nn2, NetworkType& nn_child1, NetworkType& nn_child2, uint32_t pair)
 	{
 		static_assert(N >= 0 && N < number_of_layers);
-		get_child_of_layer<N>(std::get<N>(nn1.layers), std::get<N>(nn2.layers), std::get<N>(nn_child1.layers), std::get<N>(nn_child2.layers));
+		get_child_of_layer<N>(std::get<N>(nn1.layers), std::get<N>(nn2.layers), std::get<N>(nn_child1.layers), std::get<N>(nn_child2.layers), pair);
 		
-		if constexpr (N < number_of_layers-1) get_child<N+1>(nn1, nn2, nn_child1, nn_child2);
+		if constexpr (N < number_of_layers-1) get_child<N+1>(nn1, nn2, nn_child1, nn_child2, pair);
 	}
 	
-	void get_child(const NetworkType& nn1, const NetworkType& nn2, NetworkType& nn_child1, NetworkType& nn_child2)
+	void get_child(const NetworkType& nn1, const NetworkType& nn2, NetworkType& nn_child1, NetworkType& nn_child2, uint32_t pair)
 	{
-		get_child<0>(nn1, nn2, nn_child1, nn_child2);
+		ProfileScope scope(ProfilePhase::Crossover);
+		TraceSpan span("get_child", "ga");
+		get_child<0>(nn1, nn2, nn_child1, nn_child2, pair);
 	}
 	
-	void mutate(NetworkType& nn, double rate = 0.05)
+	// Adds N(0, rate) noise keyed by (generation, individual, layer, weight). The sum is
+	// taken in double and rounded once to the type the weights are stored as.
+	void mutate(NetworkType& nn, double rate, uint32_t individual)
 	{
-		std::normal_distribution<double> dist(0,rate);
+		ProfileScope scope(ProfilePhase::Mutation);
+		TraceSpan span("mutate", "ga");
 		
-		auto mutate_function = [&dist, this]<typename Layer>(Layer& layer){
-			for (int i = 0; i < Layer::OutputSize; ++i)
-				for (int j = 0; j < Layer::InputSize; ++j)
-					layer.get_weight()(i,j) += dist(this->gen);
-		};
-		
-		std::apply([&mutate_function]<typename...L>(L&... layers)
-				{
-					((mutate_function(layers)),...);
-				}, nn.layers);
+		for_each_layer(nn, [this, rate, individual](size_t l, auto& layer) {
+			auto& w = layer.get_weight();
+			using StorageType = typename std::decay_t<decltype(w)>::Scalar;
+			for (int k = 0; k < w.size(); ++k)
+				w.data()[k] = static_cast<StorageType>(static_cast<double>(w.data()[k]) + rate * rng.normal(RandomStream::Mutation, generation, individual, l, k));
+		});
 	}
 	
 public :
 	
+	// Scores every network with the scorer, in worker processes after use_worker_processes().
+	// Networks screened out by evolve_screened are skipped.
 	void get_scores()
 	{
+		ProfileScope scope(ProfilePhase::Evaluation);
+		TraceSpan span("get_scores", "ga", "population", population.size());
+		if(worker_pool)
+		{
+			if(std::find(screened_out.begin(), screened_out.end(), true) == screened_out.end())
+			{
+				worker_pool->evaluate(population);
+				return;
+			}
+			std::vector<PopulationType> selected;
+			for(size_t i = 0; i < population.size(); i++) if(!is_screened_out(i)) selected.push_back(population[i]);
+			worker_pool->evaluate(selected);
+			for(size_t i = 0, j = 0; i < population.size(); i++) if(!is_screened_out(i)) population[i].second = selected[j++].second;
+			return;
+		}
 		for(int i = 0; i < population.size(); i++)
 		{
-			population[i].second = scorer(population[i].first);
+			if(is_screened_out(i)) continue;
+			population[i].second = scorer(*population[i].first);
 		}
 	}
 	
+	// Forks number_of_workers processes running copies of the current scorer, see process_pool.hpp. 0 goes back to scoring in process.
+	void use_worker_processes(int number_of_workers, int batch_size = 8, int pipeline_depth = 2)
+	{
+		worker_pool.reset();
+		if(number_of_workers > 0) worker_pool = std::make_shared<ProcessPool<ScorerT, NN>>(scorer, number_of_workers, batch_size, pipeline_depth);
+	}
+	
 	void sort_by_scores() {
+		ProfileScope scope(ProfilePhase::Sort);
+		TraceSpan span("sort_by_scores", "ga");
 		std::sort(population.begin(), population.end(), 
 			[=](PopulationType& a, PopulationType& b)
 			{
@@ -130,70 +169,248 @@ public :
 			});
 	}
 	
+	// Keeps the number_of_parents best and fills the rest with mutated children of parents
+	// drawn with probability proportional to their score. Every random number is keyed by
+	// the generation and the position of the child, so the children are built in parallel
+	// and the result does not depend on number_of_threads.
 	void evolve(int number_of_parents, double rate) 
 	{
+		TraceSpan span("evolve", "ga", "population", population_size);
 		assert(number_of_parents >= 2 && number_of_parents < population_size);
+		write_scores();
 		sort_by_scores();
+		std::vector<double> weights(population_size);
+		for(size_t i = 0; i < population_size; ++i) weights[i] = population[i].second;
+		breed(number_of_parents, rate, weights);
+	}
+	
+	// The same with fitness[i], higher is better, in place of the score of network i.
+	// scores.txt still gets the scores.
+	void evolve(int number_of_parents, double rate, const std::vector<double>& fitness)
+	{
+		TraceSpan span("evolve", "ga", "population", population_size);
+		assert(number_of_parents >= 2 && (size_t)number_of_parents < population_size);
+		assert(fitness.size() == population_size);
+		write_scores();
+		std::vector<size_t> order(population_size);
+		for(size_t i = 0; i < population_size; ++i) order[i] = i;
+		{
+			ProfileScope scope(ProfilePhase::Sort);
+			TraceSpan span("sort_by_fitness", "ga");
+			std::stable_sort(order.begin(), order.end(), [&fitness](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+		}
+		// Handles only: a default genome would allocate a network just to be overwritten.
+		std::vector<PopulationType> sorted;
+		sorted.reserve(population_size);
+		std::vector<double> weights(population_size);
+		for(size_t i = 0; i < population_size; ++i)
+		{
+			sorted.push_back(population[order[i]]);
+			weights[i] = fitness[order[i]];
+		}
+		population.swap(sorted);
+		breed(number_of_parents, rate, weights);
+	}
+	
+	/* Surrogate Screening */
+	
+	// Fits surrogate (see surrogate.hpp) to the networks that were scored, evolves, and
+	// screens out all children but the fraction the surrogate predicts best. Screened out
+	// networks are not scored and never become parents. Returns the number of networks
+	// left to score.
+	template <typename SurrogateType>
+	size_t evolve_screened(SurrogateType& surrogate, int number_of_parents, double rate, double fraction)
+	{
+		TraceSpan span("evolve_screened", "ga", "population", population_size);
+		assert(fraction > 0 && fraction <= 1);
+		std::vector<double> fitness(population_size);
+		for(size_t i = 0; i < population_size; ++i)
+		{
+			if(is_screened_out(i))
+			{
+				fitness[i] = -std::numeric_limits<double>::infinity();
+				continue;
+			}
+			surrogate.train(*population[i].first, population[i].second);
+			fitness[i] = population[i].second;
+		}
+		surrogate.fit();
+		evolve(number_of_parents, rate, fitness);
+		if(!surrogate.is_fitted()) return population_size;
+		
+		size_t number_of_children = population_size - number_of_parents;
+		size_t kept = std::max<size_t>(1, std::ceil(fraction * number_of_children));
+		std::vector<double> prediction(population_size);
+		parallel_for(number_of_children, [&](size_t c) {
+			prediction[number_of_parents + c] = surrogate.predict(*population[number_of_parents + c].first);
+		});
+		
+		std::vector<size_t> order(number_of_children);
+		for(size_t c = 0; c < number_of_children; ++c) order[c] = number_of_parents + c;
+		std::nth_element(order.begin(), order.begin() + (kept-1), order.end(), [&prediction](size_t a, size_t b) { return prediction[a] > prediction[b]; });
+		for(size_t c = kept; c < number_of_children; ++c) screened_out[order[c]] = true;
+		return number_of_parents + kept;
+	}
+	
+	bool is_screened_out(size_t i) const { return !screened_out.empty() && screened_out[i]; }
+	
+	// The networks that were scored, in population order. A screened out child was never
+	// scored, its score is the default ScoreType{} that breed gives every child.
+	std::vector<PopulationType> scored_population() const
+	{
+		std::vector<PopulationType> res;
+		res.reserve(population.size());
+		for(size_t i = 0; i < population.size(); ++i) if(!is_screened_out(i)) res.push_back(population[i]);
+		return res;
+	}
+	
+	/* Novelty Search */
+	
+	// Scores every network with a scorer that also reports a behavior descriptor,
+	// scorer(nn, behavior). Always in process, the worker pool only returns scores.
+	template <typename BehaviorType>
+	void get_scores(std::vector<BehaviorType>& behaviors)
+	{
+		ProfileScope scope(ProfilePhase::Evaluation);
+		TraceSpan span("get_scores", "ga", "population", population.size());
+		behaviors.resize(population.size());
+		for(size_t i = 0; i < population.size(); i++)
+		{
+			population[i].second = scorer(*population[i].first, behaviors[i]);
+		}
+	}
+	
+	// Evolves on novelty against archive (see novelty_archive.hpp) plus score_weight times
+	// the score, then adds the novel behaviors to the archive. behaviors[i] is the
+	// behavior of network i. Returns the novelty of every network.
+	template <typename Archive>
+	std::vector<double> evolve_by_novelty(Archive& archive, const std::vector<typename Archive::BehaviorType>& behaviors, int number_of_parents, double rate, double score_weight = 0)
+	{
+		assert(behaviors.size() == population_size);
+		std::vector<double> novelty = archive.novelty(behaviors, number_of_threads);
+		std::vector<double> fitness(population_size);
+		for(size_t i = 0; i < population_size; ++i) fitness[i] = novelty[i] + score_weight * population[i].second;
+		archive.update(behaviors, novelty);
+		evolve(number_of_parents, rate, fitness);
+		return novelty;
+	}
+	
+private :
+	// Appends the scores in sorted, best first, to scores.txt.
+	void write_scores(const std::vector<PopulationType>& sorted)
+	{
+		ProfileScope scope(ProfilePhase::Telemetry);
+		TraceSpan span("write scores", "io");
 		std::ofstream file;
 		file.open("scores.txt", std::ios::out | std::ios_base::app);
 		if(file.is_open())
 		{
-			for(int i = 0; i < population.size(); ++i) {
-				file << population[i].second;
-				if(i == population.size() - 1) file << ";" << std::endl;
+			for(int i = 0; i < sorted.size(); ++i) {
+				file << sorted[i].second;
+				if(i == sorted.size() - 1) file << ";" << std::endl;
 				else file << ", ";
 			}
 		} 
 		file.close();
-		std::vector<PopulationType> next_generation (population_size);
-		for(int i = 0; i < number_of_parents; ++i) next_generation[i] = population[i];
-		std::vector<int> vec(population_size);
-		for(int i = 0; i < population_size; ++i)
-		{
-			vec.push_back(population[i].second);
-		}
-		std::discrete_distribution<int> dist(vec.begin(), vec.end());
+	}
+	
+	// Screened out networks are left out. Called before the population is reordered.
+	void write_scores()
+	{
+		std::vector<PopulationType> by_score = scored_population();
+		std::stable_sort(by_score.begin(), by_score.end(), [this](const PopulationType& a, const PopulationType& b) { return scorer.compare(a.second, b.second); });
+		write_scores(by_score);
+	}
+	
+	// Builds the next generation from population sorted best first, selecting parents with
+	// probability proportional to max(weight, 0). The parents kept are shared with the
+	// last generation, and children are built in place in genomes of their own.
+	void breed(int number_of_parents, double rate, const std::vector<double>& weights)
+	{
+		// Only the children get genomes of their own; the parents are pushed as handles.
+		std::vector<PopulationType> next_generation;
+		next_generation.reserve(population_size);
+		for(int i = 0; i < number_of_parents; ++i) next_generation.push_back(population[i]);
+		next_generation.resize(population_size);
 		
-		for(int i = number_of_parents; i < population_size; ++i)
-		{
-			int index1 = dist(gen) % population_size;
-			int index2 = dist(gen) % population_size;
-			
-			while(index1 == index2) {
-				index1 = dist(gen) % population_size;
-				index2 = dist(gen) % population_size;
-			}
-			
-			const NetworkType& parent1 = population[index1].first;
-			const NetworkType& parent2 = population[index2].first;
-			
-			NetworkType child1, child2;
-			
-			get_child(parent1, parent2, child1, child2);
+		std::vector<double> cumulative(population_size);
+		double total = 0;
+		for(size_t i = 0; i < population_size; ++i) cumulative[i] = total += std::max<double>(weights[i], 0);
+		
+		size_t number_of_pairs = (population_size - number_of_parents + 1)/2;
+		parallel_for(number_of_pairs, [&](size_t pair) {
+			size_t i = number_of_parents + 2*pair;
+			auto [index1, index2] = select_parents(cumulative, pair);
 			
-			mutate(child1, rate);
-			mutate(child2, rate);
+			// The last odd child has nowhere to go and is built on the stack.
+			NetworkType spare;
+			NetworkType& child1 = next_generation[i].first.write();
+			NetworkType& child2 = (i+1 < population_size) ? next_generation[i+1].first.write() : spare;
+			get_child(*population[index1].first, *population[index2].first, child1, child2, pair);
 			
-			next_generation[i] = {child1, 0};
-			if (i >= population_size-1) break;
-			next_generation[i+1] = {child2, 0};
+			mutate(child1, rate, i);
+			if (i+1 < population_size) mutate(child2, rate, i+1);
+		});
+		population.swap(next_generation);
+		screened_out.assign(population_size, false);
+		++generation;
+	}
+	
+	// Roulette wheel selection of two different parents with keyed uniforms. Uniform when
+	// every score is 0, and for the second parent when the first holds nearly all the weight.
+	std::pair<size_t, size_t> select_parents(const std::vector<double>& cumulative, uint32_t pair) const
+	{
+		ProfileScope scope(ProfilePhase::Selection);
+		double total = cumulative.back();
+		auto draw = [&](uint32_t k, bool weighted) -> size_t {
+			double u = rng.uniform(RandomStream::Selection, generation, pair, 0, k);
+			if(total <= 0 || !weighted) return std::min<size_t>(u * population_size, population_size-1);
+			size_t index = std::upper_bound(cumulative.begin(), cumulative.end(), u * total) - cumulative.begin();
+			return std::min<size_t>(index, population_size-1);
+		};
+		
+		uint32_t k = 0;
+		size_t index1 = draw(k++, true), index2 = draw(k++, true);
+		while(index1 == index2)
+		{
+			index2 = draw(k, k < 64);
+			++k;
 		}
-		population = next_generation;
+		return {index1, index2};
+	}
+	
+	// Calls f(i) for i in [0, n), split in contiguous blocks over number_of_threads threads.
+	template <typename F>
+	void parallel_for(size_t n, F f)
+	{
+		int threads_used = std::max(1, std::min<int>(number_of_threads, n));
+		auto block = [n, threads_used, &f](int t) {
+			for(size_t i = n*t/threads_used; i < n*(t+1)/threads_used; ++i) f(i);
+		};
+		
+		std::vector<std::thread> threads;
+		for(int t = 1; t < threads_used; ++t) threads.emplace_back(block, t);
+		block(0);
+		for(auto& thread : threads) thread.join();
 	}
 	
 public :
 	std::vector<PopulationType> population;
 	ScorerT scorer;
 	size_t population_size;
-	std::default_random_engine gen;
+	CounterRNG rng;
+	uint32_t generation = 0;
+	int number_of_threads = 1;
+	std::shared_ptr<ProcessPool<ScorerT, NN>> worker_pool;
+	std::vector<bool> screened_out;
 };
 
 template <typename ScoreT, typename...Layers>
 void save_to_file(std::ofstream& file, const GeneticAlgorithm<ScoreT, Layers...>& genetic_algorithm)
 {
 	if(!file.is_open()) return;
-	for (auto p : genetic_algorithm.population)
-		save_to_file(file, p.first);
+	for (const auto& p : genetic_algorithm.population)
+		save_to_file(file, *p.first);
 }
 
 template <typename ScoreT, typename...Layers>
@@ -201,7 +418,7 @@ void read_from_file(std::ifstream& file, GeneticAlgorithm<ScoreT, Layers...>& ge
 {
 	if(!file.is_open()) return;
 	for(auto& p : genetic_algorithm.population)
-		read_from_file(file, p.first);
+		read_from_file(file, p.first.write());
 }
 
 }
@@ -0,0 +1,59 @@
+/*
+ * genome.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_GENOME_HPP_
+#define SRC_GENOME_HPP_
+
+#include <memory>
+#include <cassert>
+
+namespace neural
+{
+
+/*
+ *  Genome.
+ *
+ *  A reference counted handle to a network. Copying a genome copies the handle, so the
+ *  elites a generation carries over, a network queued for scoring and the population
+ *  slot it ends up in all share the same weights. What a genome points to is read-only:
+ *  write() gives a network of its own to change, copying the weights only when another
+ *  genome still shares them.
+ *
+ *  Every genome is created with a network of its own, so write() on a fresh genome never
+ *  copies. The counts are atomic and the shared network is never written, so genomes can
+ *  be copied and read from any thread; a single genome is not written from two.
+ */
+
+template <typename NN>
+class Genome
+{
+public :
+	using NetworkType = NN;
+
+	Genome() : network{std::make_shared<NetworkType>()} {}
+	explicit Genome(const NetworkType& nn) : network{std::make_shared<NetworkType>(nn)} {}
+
+	const NetworkType& operator*() const { return *network; }
+	const NetworkType* operator->() const { return network.get(); }
+
+	// The network to change, copied first if another genome shares it.
+	NetworkType& write()
+	{
+		if(network.use_count() > 1) network = std::make_shared<NetworkType>(*network);
+		return *network;
+	}
+
+	// True if both genomes hold the same network, not just equal weights.
+	bool shares(const Genome& other) const { return network == other.network; }
+
+private :
+	std::shared_ptr<NetworkType> network;
+};
+
+}
+
+#endif /* SRC_GENOME_HPP_ */
@@ -13,81 +13,106 @@
 #include <tuple>
 #include <cassert>
 
-#include <random>
+#include <cstdint>
 
 #include "concepts.hpp"
+#include "counter_rng.hpp"
 
 namespace neural
 {
 
+/*
+ *  Initializers draw from a CounterRNG keyed by (seed, individual, layer, element), so a
+ *  population can be initialized in parallel with the same result as serially.
+ *  initialize(layer, individual, layer_index) is the keyed form. initialize(layer) numbers
+ *  the layers it is given in order of the calls. A matrix is always given its key, since
+ *  two matrices drawn from the same key get the same values. Layer indices are below 65536.
+ */
 
 class GaussianInitializer {
 public:
-	GaussianInitializer(double mean_, double stddev_)
-		: distribution{mean_, stddev_}
+	GaussianInitializer(double mean_, double stddev_, uint64_t seed = 0)
+		: mean{mean_}, stddev{stddev_}, rng{seed}
 	{}
 	
 	template<typename Scalar, int Rows, int Cols>
-	void initialize(Eigen::Matrix<Scalar, Rows, Cols>& mat) {
-		for (int i = 0; i < Rows; ++i) {
-			for (int j = 0; j < Cols; ++j) {
-				mat(i,j) = distribution(generator);
-			}
-		}
+	void initialize(Eigen::Matrix<Scalar, Rows, Cols>& mat, uint32_t individual, uint32_t layer_index) const {
+		for (int i = 0; i < mat.size(); ++i)
+			mat.data()[i] = static_cast<Scalar>(mean + stddev * rng.normal(RandomStream::Initialization, 0, individual, layer_index, i));
 	}
 	
 	template<layer_type LayerT>
-	void initialize(LayerT& layer) {
-		for (int i = 0; i < LayerT::OutputSize; ++i) {
-			for (int j = 0; j < LayerT::InputSize; ++j) {
-				layer.get_weight()(i,j) = distribution(generator);
-			}
-		}
+	void initialize(LayerT& layer, uint32_t individual, uint32_t layer_index) const {
+		initialize(layer.get_weight(), individual, layer_index);
 	}
 	
+	template<layer_type LayerT>
+	void initialize(LayerT& layer) { initialize(layer, 0, calls++); }
+	
 private :
-	std::default_random_engine generator;
-	std::normal_distribution<double> distribution;
+	double mean;
+	double stddev;
+	CounterRNG rng;
+	uint32_t calls = 0;
 };
 
 class UniformInitializer {
 public:
-	UniformInitializer(double left_, double right_)
-		: distribution{left_, right_}
+	UniformInitializer(double left_, double right_, uint64_t seed = 0)
+		: left{left_}, right{right_}, rng{seed}
 	{}
 	
-	template<typename LayerT>
-	void initialize(LayerT& layer) {
-		for (int i = 0; i < LayerT::OutputSize; ++i) {
-			for (int j = 0; j < LayerT::InputSize; ++j) {
-				layer.get_weight()(i,j) = distribution(generator);
-			}
-		}
+	template<typename Scalar, int Rows, int Cols>
+	void initialize(Eigen::Matrix<Scalar, Rows, Cols>& mat, uint32_t individual, uint32_t layer_index) const {
+		for (int i = 0; i < mat.size(); ++i)
+			mat.data()[i] = static_cast<Scalar>(left + (right - left) * rng.uniform(RandomStream::Initialization, 0, individual, layer_index, i));
+	}
+	
+	template<layer_type LayerT>
+	void initialize(LayerT& layer, uint32_t individual, uint32_t layer_index) const {
+		initialize(layer.get_weight(), individual, layer_index);
 	}
 	
+	template<layer_type LayerT>
+	void initialize(LayerT& layer) { initialize(layer, 0, calls++); }
+	
 private :
-	std::default_random_engine generator;
-	std::uniform_real_distribution<double> distribution;
+	double left;
+	double right;
+	CounterRNG rng;
+	uint32_t calls = 0;
 };
 
+// Glorot uniform: U(-a, a) with a = sqrt(6/(inputs + outputs)).
 class XavierInitializer {
 public :
-	XavierInitializer()
-		: distribution{-1, 1}
+	XavierInitializer(uint64_t seed = 0)
+		: rng{seed}
 	{}
 	
-	template<typename LayerT>
-	void initialize(LayerT& layer) {
-		for (int i = 0; i < LayerT::OutputSize; ++i) {
-			for (int j = 0; j < LayerT::InputSize; ++j) {
-				layer.get_weight()(i,j) = sqrt((LayerT::Outputs+LayerT::Inputs)/6.0) * distribution(generator);
-			}
-		}
+	// A matrix has no layer sizes, so outputs and inputs are its rows and columns.
+	template<typename Scalar, int Rows, int Cols>
+	void initialize(Eigen::Matrix<Scalar, Rows, Cols>& mat, uint32_t individual, uint32_t layer_index) const {
+		fill(mat, std::sqrt(6.0/(mat.rows() + mat.cols())), individual, layer_index);
 	}
 	
+	template<layer_type LayerT>
+	void initialize(LayerT& layer, uint32_t individual, uint32_t layer_index) const {
+		fill(layer.get_weight(), std::sqrt(6.0/(LayerT::OutputSize+LayerT::InputSize)), individual, layer_index);
+	}
+	
+	template<layer_type LayerT>
+	void initialize(LayerT& layer) { initialize(layer, 0, calls++); }
+	
 private :
-	std::default_random_engine generator;
-	std::uniform_real_distribution<double> distribution;
+	template<typename Scalar, int Rows, int Cols>
+	void fill(Eigen::Matrix<Scalar, Rows, Cols>& w, double a, uint32_t individual, uint32_t layer_index) const {
+		for (int i = 0; i < w.size(); ++i)
+			w.data()[i] = static_cast<Scalar>(a * (2 * rng.uniform(RandomStream::Initialization, 0, individual, layer_index, i) - 1));
+	}
+	
+	CounterRNG rng;
+	uint32_t calls = 0;
 };
 
 }
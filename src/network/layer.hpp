@@ -1,136 +1,392 @@
 /*
- * perceptron_layer.hpp
+ * layer.hpp
  *
  *  Created on: Dec 4, 2023
  *      Author: reidharris
  */
 
-#ifndef SRC_PERCEPTRON_LAYER_HPP_
-#define SRC_PERCEPTRON_LAYER_HPP_
+#ifndef SRC_LAYER_HPP_
+#define SRC_LAYER_HPP_
 
 #include <Eigen/Dense>
 #include <cmath>
 #include <tuple>
 #include <cassert>
 #include <type_traits>
+#include <utility>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
-#include "initialization.hpp"
+#include <vector>
+#include <algorithm>
+
 #include "concepts.hpp"
+#include "math_functions.hpp"
+#include "perceptron_layer.hpp"
+#include "plain_neural_network.hpp"
 
 namespace neural
 {
 
-/* Perceptron Layer */
+/*
+ *  Runtime-shaped networks.
+ *
+ *  NeuralNetwork<Layers...> fixes its topology at compile time. DynamicNeuralNetwork
+ *  reads it from the header of a checkpoint instead, so a sweep over topologies is a
+ *  sweep over files.
+ *
+ *  There is no virtual layer. Every layer picks its kernel once, when it is given its
+ *  shape. If the shape is one of kernel_shapes, the kernel is a product instantiated
+ *  for that shape, which Eigen unrolls and vectorizes as it would in a fixed network.
+ *  Any other shape uses Eigen's general matrix-vector product, which works through the
+ *  matrix in cache-sized blocks. A forward pass is then one call through a function
+ *  pointer per layer and a switch on the activation, with the activations kept in two
+ *  buffers on the stack.
+ */
+
+/* Activations */
+
+enum class ActivationType { Sigmoid, Tanh, ReLU };
+
+template <template<typename> class ActivationFunction>
+struct activation_type;
+
+template <> struct activation_type<sigmoid> 	{ static constexpr ActivationType value = ActivationType::Sigmoid; };
+template <> struct activation_type<tanh> 		{ static constexpr ActivationType value = ActivationType::Tanh; };
+template <> struct activation_type<ReLU> 		{ static constexpr ActivationType value = ActivationType::ReLU; };
+
+inline const char* activation_name(ActivationType a)
+{
+	switch(a)
+	{
+		case ActivationType::Sigmoid : return "sigmoid";
+		case ActivationType::Tanh : return "tanh";
+		case ActivationType::ReLU : return "relu";
+	}
+	return "";
+}
+
+inline bool activation_from_name(const std::string& name, ActivationType& a)
+{
+	for(ActivationType t : {ActivationType::Sigmoid, ActivationType::Tanh, ActivationType::ReLU})
+		if(name == activation_name(t))
+		{
+			a = t;
+			return true;
+		}
+	return false;
+}
+
+/* Kernels */
+
+// y = W x, with W column-major, rows by cols.
+template <typename Scalar>
+using KernelType = void (*)(const Scalar* w, int rows, int cols, const Scalar* x, Scalar* y);
 
-template <typename ScalarType = double>
-class Layer {
-	virtual Layer(int inputs, int outputs) = 0;
-	virtual Vector feed_forward(Vector input) = 0;
-	virtual Matrix get_weight() = 0;
-	virtual void set_weight() = 0;
-	
+struct KernelShape { int rows; int cols; };
+
+// Shapes, outputs by inputs, with a kernel of their own: every pair of powers of two
+// from 2 to 128, and the layers of the asteroids and snake networks. Every shape costs
+// compile time in every file that includes this one.
+inline constexpr KernelShape kernel_shapes[] = {
+	{2, 2}, {2, 4}, {2, 8}, {2, 16}, {2, 32}, {2, 64}, {2, 128},
+	{4, 2}, {4, 4}, {4, 8}, {4, 16}, {4, 32}, {4, 64}, {4, 128},
+	{8, 2}, {8, 4}, {8, 8}, {8, 16}, {8, 32}, {8, 64}, {8, 128},
+	{16, 2}, {16, 4}, {16, 8}, {16, 16}, {16, 32}, {16, 64}, {16, 128},
+	{32, 2}, {32, 4}, {32, 8}, {32, 16}, {32, 32}, {32, 64}, {32, 128},
+	{64, 2}, {64, 4}, {64, 8}, {64, 16}, {64, 32}, {64, 64}, {64, 128},
+	{128, 2}, {128, 4}, {128, 8}, {128, 16}, {128, 32}, {128, 64}, {128, 128},
+	{30, 16}, {2, 30}, {20, 8}, {4, 20}
 };
 
-template < typename ScalarType>
-class PerceptronLayerDynamic : public Layer
+template <typename Scalar, int Rows, int Cols>
+void fixed_kernel(const Scalar* w, int, int, const Scalar* x, Scalar* y)
+{
+	Eigen::Map<Eigen::Matrix<Scalar, Rows, 1>>(y).noalias()
+		= Eigen::Map<const Eigen::Matrix<Scalar, Rows, Cols>>(w) * Eigen::Map<const Eigen::Matrix<Scalar, Cols, 1>>(x);
+}
+
+template <typename Scalar>
+void dynamic_kernel(const Scalar* w, int rows, int cols, const Scalar* x, Scalar* y)
+{
+	using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+	Eigen::Map<Vector>(y, rows).noalias()
+		= Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>(w, rows, cols) * Eigen::Map<const Vector>(x, cols);
+}
+
+template <typename Scalar>
+KernelType<Scalar> select_kernel(int rows, int cols)
+{
+	KernelType<Scalar> res = &dynamic_kernel<Scalar>;
+	[&]<size_t... K>(std::index_sequence<K...>) {
+		((rows == kernel_shapes[K].rows && cols == kernel_shapes[K].cols
+			? (void)(res = &fixed_kernel<Scalar, kernel_shapes[K].rows, kernel_shapes[K].cols>) : (void)0), ...);
+	}(std::make_index_sequence<std::size(kernel_shapes)>{});
+	return res;
+}
+
+/* Perceptron Layer */
+
+template <typename Scalar = double>
+class PerceptronLayerDynamic
 {
 public :
-	static_assert(NumInputs > 0 && NumOutputs > 0);
-	using Scalar = ScalarType;
-	
+	using ScalarType = Scalar;
+
 	static constexpr bool HasParameters = true;
-	
-	using InputType  = Eigen::Matrix<Scalar, Dynamic, 1>;
-	using OutputType = Eigen::Matrix<Scalar, Dynamic, 1>;
-	using WeightType = Eigen::Matrix<Scalar, Dynamic, Dynamic>;
+
+	using VectorType = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+	using WeightType = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
 public :
-	PerceptronLayerDynamic(int inputs, int outputs) : weight(outputs, inputs) {}
-	
+	PerceptronLayerDynamic(int inputs, int outputs, ActivationType activation_ = ActivationType::Sigmoid)
+		: weight{WeightType::Zero(outputs, inputs)}
+		, activation{activation_}
+		, kernel{select_kernel<Scalar>(outputs, inputs)}
+	{
+		assert(inputs > 0 && outputs > 0);
+	}
+
+	// The same layer with runtime shape, weights widened to Scalar if stored narrower.
+	template <typename S, int NumInputs, int NumOutputs, template<typename> class A, typename Storage>
+	explicit PerceptronLayerDynamic(const PerceptronLayer<S, NumInputs, NumOutputs, A, Storage>& layer)
+		: PerceptronLayerDynamic(NumInputs, NumOutputs, activation_type<A>::value)
+	{
+		weight = layer.get_weight().template cast<Scalar>();
+	}
+
 	template <typename Initializer>
-	void initialize(Initializer& init) { init.initialize(*this); }
-	
-	OutputType feed_forward(const InputType& input) { return (weight*input).unaryExpr(&activation_function); }
-	
-	void set_weight(WeightType& weight_) { 
-		assert(weight_.rows() == outputs && weight_.cols() == inputs);
-		weight = weight_;
+	void initialize(const Initializer& init, uint32_t individual, uint32_t layer_index) { init.initialize(weight, individual, layer_index); }
+
+	// output must have room for outputs() scalars and not overlap input.
+	void feed_forward(const Scalar* input, Scalar* output) const
+	{
+		kernel(weight.data(), weight.rows(), weight.cols(), input, output);
+		Eigen::Map<VectorType> y(output, weight.rows());
+		switch(activation)
+		{
+			case ActivationType::Sigmoid : y = y.unaryExpr(&sigmoid<Scalar>::eval); break;
+			case ActivationType::Tanh : y = y.unaryExpr(&tanh<Scalar>::eval); break;
+			case ActivationType::ReLU : y = y.unaryExpr(&ReLU<Scalar>::eval); break;
+		}
 	}
+
+	VectorType feed_forward(const VectorType& input) const
+	{
+		assert(input.size() == inputs());
+		VectorType res(outputs());
+		feed_forward(input.data(), res.data());
+		return res;
+	}
+
+	WeightType& get_weight() { return weight; }
 	const WeightType& get_weight() const { return weight; }
-	void set_weight_entry(ScalarType x, int i, int j) { weight(i,j) = x; }
-	
-	int inputs() const { return inputs; }
-	int outputs() const { return outputs; }
-	
+
+	int inputs() const { return weight.cols(); }
+	int outputs() const { return weight.rows(); }
+	ActivationType get_activation() const { return activation; }
+
+	// True if the layer runs a kernel instantiated for its shape.
+	bool is_specialized() const { return kernel != &dynamic_kernel<Scalar>; }
+
 private :
 	WeightType weight;
-	std::function<Scalar(Scalar)> activation_function;
-	int inputs;
-	int outputs;
+	ActivationType activation;
+	KernelType<Scalar> kernel;
 };
 
-template <typename ScalarType>
-class NeuralNetwork {
-	
-};
+/* Neural Network */
 
-template <typename Scalar>
-void read_from_file(std::ifstream& file, PerceptronLayerDynamic<Scalar>& layer)
+template <typename Scalar = double>
+class DynamicNeuralNetwork
 {
-	if(!file.is_open()) return;
-	std::string matrix_string;
-	getline(file, matrix_string);
-	std::stringstream matrix_stream(matrix_string);
-	std::string entry;
-	int number_of_parameters = layer.inputs()*layer.outputs();
-	
-	int i=0, r=0, c=0;
-	
-	
-	while(std::getline(matrix_stream, entry, ','))
-	{
-		assert(i < number_of_parameters);
-		layer.set_weight_entry(std::stod(entry),r,c);
-		r = r + (c+1)/NumInputs;
-		c = (c+1)%NumInputs;
-		++i;
-	}
-	assert(i == number_of_parameters);
-}
+public :
+	using ScalarType = Scalar;
+	using LayerType  = PerceptronLayerDynamic<Scalar>;
+	using VectorType = typename LayerType::VectorType;
 
-template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation>
-void save_to_file(std::ofstream& file, const PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation>& layer)
-{
-	Eigen::IOFormat CommaInitFmt(Eigen::FullPrecision, Eigen::DontAlignCols, ", ", ", ", "", "");
-	if(file.is_open()) file << layer.get_weight().format(CommaInitFmt) << std::endl;
-}
+	// Networks up to this wide keep their activations on the stack.
+	static constexpr int StackWidth = 256;
+public :
+	DynamicNeuralNetwork() {}
+
+	// The same network with runtime shapes.
+	template <typename... Layers>
+	explicit DynamicNeuralNetwork(const NeuralNetwork<Layers...>& nn)
+	{
+		std::apply([this](const Layers&... l) { ((add_layer(LayerType(l))), ...); }, nn.layers);
+	}
 
-/* Specializations */
+	// Appends a layer, which must take the outputs of the last one.
+	void add_layer(const LayerType& layer)
+	{
+		assert(layers.empty() || layers.back().outputs() == layer.inputs());
+		layers.push_back(layer);
+		width = std::max({width, layer.inputs(), layer.outputs()});
+	}
 
-template <int NumInputs, int NumOutputs>
-using SigmoidLayer = PerceptronLayer<double, NumInputs, NumOutputs, sigmoid>;
+	void add_layer(int inputs, int outputs, ActivationType activation) { add_layer(LayerType(inputs, outputs, activation)); }
+
+	// output is resized only if it has the wrong size.
+	void feed_forward(const VectorType& input, VectorType& output) const
+	{
+		assert(!layers.empty() && input.size() == input_size());
+		output.resize(output_size());
+		if(width <= StackWidth)
+		{
+			alignas(64) Scalar buffer[2][StackWidth];
+			run(input.data(), output.data(), buffer[0], buffer[1]);
+		}
+		else
+		{
+			std::vector<Scalar> buffer(2*width);
+			run(input.data(), output.data(), buffer.data(), buffer.data() + width);
+		}
+	}
+
+	VectorType feed_forward(const VectorType& input) const
+	{
+		VectorType res(output_size());
+		feed_forward(input, res);
+		return res;
+	}
 
-template <int NumInputs, int NumOutputs>
-using TanhLayer = PerceptronLayer<double, NumInputs, NumOutputs, tanh>;
+	// Feeds every column of input through the network at once.
+	Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> feed_forward_batch(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& input) const
+	{
+		Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> res = input;
+		for(const auto& layer : layers)
+		{
+			res = layer.get_weight() * res;
+			switch(layer.get_activation())
+			{
+				case ActivationType::Sigmoid : res = res.unaryExpr(&sigmoid<Scalar>::eval); break;
+				case ActivationType::Tanh : res = res.unaryExpr(&tanh<Scalar>::eval); break;
+				case ActivationType::ReLU : res = res.unaryExpr(&ReLU<Scalar>::eval); break;
+			}
+		}
+		return res;
+	}
 
-template <int NumInputs, int NumOutputs>
-using ReLULayer = PerceptronLayer<double, NumInputs, NumOutputs, ReLU>;
+	// Keyed by individual and layer index like NeuralNetwork::initialize, so a network of
+	// the same shape gets the same weights and no two layers get the same stream.
+	template <typename Initializer>
+	void initialize(const Initializer& init, uint32_t individual = 0)
+	{
+		for(size_t l = 0; l < layers.size(); ++l) layers[l].initialize(init, individual, l);
+	}
 
-/* Type Traits */
+	int input_size() const { return layers.empty() ? 0 : layers.front().inputs(); }
+	int output_size() const { return layers.empty() ? 0 : layers.back().outputs(); }
+	size_t number_of_layers() const { return layers.size(); }
 
-template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
-constexpr bool is_layer<PerceptronLayer<Scalar, NumInputs, NumOutputs, ActivationFunction>> 	= true;
+	std::vector<LayerType> layers;
 
-template <int NumInputs, int NumOutputs>
-constexpr bool is_layer<SigmoidLayer<NumInputs, NumOutputs>	> 	= true;
+private :
+	// Layer l reads from the output of layer l-1 and writes to the other buffer, the last one to output.
+	void run(const Scalar* input, Scalar* output, Scalar* a, Scalar* b) const
+	{
+		const Scalar* x = input;
+		for(size_t l = 0; l < layers.size(); ++l)
+		{
+			Scalar* y = (l + 1 == layers.size()) ? output : (l % 2 ? b : a);
+			layers[l].feed_forward(x, y);
+			x = y;
+		}
+	}
 
-template <int NumInputs, int NumOutputs>
-constexpr bool is_layer<ReLULayer<NumInputs, NumOutputs>	> 	= true;
+	int width = 0;
+};
 
-template <int NumInputs, int NumOutputs>
-constexpr bool is_layer<TanhLayer<NumInputs, NumOutputs>	> 	= true;
+/*
+ *  Checkpoint header.
+ *
+ *  One line before the weights of a network gives its shape, every layer as its inputs,
+ *  outputs and activation:
+ *
+ *  	layers: 16 30 sigmoid; 30 2 tanh
+ *
+ *  save_shape writes it for a fixed network, so its checkpoints can be read by a
+ *  DynamicNeuralNetwork as well.
+ */
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class A, typename Storage>
+void save_shape(std::ostream& stream, const PerceptronLayer<Scalar, NumInputs, NumOutputs, A, Storage>&)
+{
+	stream << " " << NumInputs << " " << NumOutputs << " " << activation_name(activation_type<A>::value) << ";";
+}
+
+template <typename... Layers>
+void save_shape(std::ofstream& file, const NeuralNetwork<Layers...>& nn)
+{
+	std::ostringstream line;
+	line << "layers:";
+	std::apply([&line](const Layers&... l) { ((save_shape(line, l)), ...); }, nn.layers);
+	std::string shape = line.str();
+	shape.pop_back();
+	if(file.is_open()) file << shape << std::endl;
+}
+
+template <typename Scalar>
+void save_to_file(std::ofstream& file, const DynamicNeuralNetwork<Scalar>& nn)
+{
+	if(!file.is_open())
+	{
+		std::cout << "File not open. Cannot be saved." << std::endl;
+		return;
+	}
+	file << "layers:";
+	for(size_t l = 0; l < nn.layers.size(); ++l)
+		file << (l ? "; " : " ") << nn.layers[l].inputs() << " " << nn.layers[l].outputs() << " " << activation_name(nn.layers[l].get_activation());
+	file << std::endl;
+	for(const auto& layer : nn.layers) save_weights(file, layer.get_weight());
+}
+
+// Reads the header and then the weights. False, with nn unchanged, if the header is not a valid shape.
+template <typename Scalar>
+bool read_from_file(std::ifstream& file, DynamicNeuralNetwork<Scalar>& nn)
+{
+	if(!file.is_open())
+	{
+		std::cout << "File not open. Cannot be read." << std::endl;
+		return false;
+	}
+	std::string header;
+	getline(file, header);
+	const std::string prefix = "layers:";
+	if(header.compare(0, prefix.size(), prefix) != 0)
+	{
+		std::cout << "No network shape in checkpoint header: " << header << std::endl;
+		return false;
+	}
+
+	DynamicNeuralNetwork<Scalar> res;
+	std::stringstream stream(header.substr(prefix.size()));
+	std::string entry;
+	while(std::getline(stream, entry, ';'))
+	{
+		std::stringstream layer_stream(entry);
+		int inputs = 0, outputs = 0;
+		std::string name;
+		ActivationType activation;
+		if(!(layer_stream >> inputs >> outputs >> name) || inputs <= 0 || outputs <= 0 || !activation_from_name(name, activation)
+		   || (res.number_of_layers() && res.output_size() != inputs))
+		{
+			std::cout << "Invalid layer in checkpoint header: " << entry << std::endl;
+			return false;
+		}
+		res.add_layer(inputs, outputs, activation);
+	}
+	if(!res.number_of_layers())
+	{
+		std::cout << "No layers in checkpoint header." << std::endl;
+		return false;
+	}
+	for(auto& layer : res.layers) read_weights(file, layer.get_weight());
+	nn = std::move(res);
+	return true;
+}
 
 }
 
-#endif /* SRC_PERCEPTRON_LAYER_HPP_ */
+#endif /* SRC_LAYER_HPP_ */
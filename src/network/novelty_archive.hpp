@@ -0,0 +1,303 @@
+/*
+ * novelty_archive.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_NOVELTY_ARCHIVE_HPP_
+#define SRC_NOVELTY_ARCHIVE_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include "trace.hpp"
+
+namespace neural
+{
+
+/*
+ *  KD-tree.
+ *
+ *  Exact k nearest neighbors over Dim dimensional points, with points added one at a
+ *  time. Every node holds one point, point i is node i, so an index into the tree is
+ *  also an index into the points and never changes.
+ *
+ *  Insertions keep the tree balanced like a scapegoat tree: when a new leaf ends up
+ *  deeper than log(n)/log(1/alpha), the closest ancestor on its path whose child holds
+ *  more than alpha of its subtree is rebuilt around medians. Lookups then stay
+ *  O(log n) deep whatever order the points come in, and an insertion costs amortized
+ *  O(log^2 n).
+ */
+
+template <int Dim>
+class KDTree
+{
+public :
+	using PointType = Eigen::Matrix<double, Dim, 1>;
+	using Neighbor  = std::pair<double, size_t>;	// Squared distance, index.
+
+	static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+	KDTree() = default;
+
+	// Builds a balanced tree over points in one go.
+	explicit KDTree(const std::vector<PointType>& points_)
+		: points(points_)
+		, nodes(points_.size())
+	{
+		std::vector<int> indices(points.size());
+		for(size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+		root = build(indices.begin(), indices.end());
+	}
+
+	void insert(const PointType& point)
+	{
+		int index = points.size();
+		points.push_back(point);
+		nodes.push_back(Node{});
+		if(root < 0)
+		{
+			root = index;
+			return;
+		}
+
+		path.clear();
+		for(int n = root; n >= 0;)
+		{
+			path.push_back(n);
+			++nodes[n].size;
+			int& child = (point(nodes[n].axis) < points[n](nodes[n].axis)) ? nodes[n].left : nodes[n].right;
+			if(child < 0)
+			{
+				child = index;
+				break;
+			}
+			n = child;
+		}
+
+		if(path.size() <= max_depth(points.size())) return;
+		// Find the scapegoat, the closest unbalanced ancestor, and rebuild its subtree.
+		for(size_t d = path.size(); d-- > 0;)
+		{
+			const Node& node = nodes[path[d]];
+			size_t heaviest = std::max(subtree_size(node.left), subtree_size(node.right));
+			if(heaviest > alpha * node.size)
+			{
+				rebuild(d);
+				return;
+			}
+		}
+	}
+
+	// The k nearest points to query, closest first. Point exclude is skipped, so a point of the tree can be queried against the others.
+	void nearest(const PointType& query, size_t k, std::vector<Neighbor>& result, size_t exclude = none) const
+	{
+		result.clear();
+		if(k == 0 || root < 0) return;
+		search(root, query, k, exclude, result);
+		std::sort_heap(result.begin(), result.end());
+	}
+
+	size_t size() const { return points.size(); }
+	const PointType& operator[](size_t i) const { return points[i]; }
+	const std::vector<PointType>& get_points() const { return points; }
+
+private :
+	struct Node {
+		int left = -1;
+		int right = -1;
+		int axis = 0;
+		size_t size = 1;
+	};
+
+	static constexpr double alpha = 0.7;
+
+	static size_t max_depth(size_t n) { return std::log(n) / std::log(1/alpha) + 1; }
+
+	size_t subtree_size(int n) const { return (n < 0) ? 0 : nodes[n].size; }
+
+	// Splits on the axis of largest spread at the median, so left <= split <= right.
+	int build(std::vector<int>::iterator begin, std::vector<int>::iterator end)
+	{
+		if(begin == end) return -1;
+		PointType low = points[*begin], high = points[*begin];
+		for(auto i = begin; i != end; ++i)
+		{
+			low = low.cwiseMin(points[*i]);
+			high = high.cwiseMax(points[*i]);
+		}
+		int axis;
+		(high - low).maxCoeff(&axis);
+
+		auto middle = begin + (end - begin)/2;
+		std::nth_element(begin, middle, end, [this, axis](int a, int b) { return points[a](axis) < points[b](axis); });
+		Node& node = nodes[*middle];
+		node.axis = axis;
+		node.size = end - begin;
+		int left = build(begin, middle);
+		int right = build(middle + 1, end);
+		node.left = left;
+		node.right = right;
+		return *middle;
+	}
+
+	// Rebuilds the subtree of path[d] and hangs it back where it was.
+	void rebuild(size_t d)
+	{
+		int top = path[d];
+		std::vector<int> indices;
+		indices.reserve(nodes[top].size);
+		std::vector<int> stack {top};
+		while(!stack.empty())
+		{
+			int n = stack.back();
+			stack.pop_back();
+			indices.push_back(n);
+			if(nodes[n].left >= 0) stack.push_back(nodes[n].left);
+			if(nodes[n].right >= 0) stack.push_back(nodes[n].right);
+		}
+
+		int subtree = build(indices.begin(), indices.end());
+		if(d == 0) root = subtree;
+		else if(nodes[path[d-1]].left == top) nodes[path[d-1]].left = subtree;
+		else nodes[path[d-1]].right = subtree;
+	}
+
+	// result is a max heap on distance holding the best k so far.
+	void search(int n, const PointType& query, size_t k, size_t exclude, std::vector<Neighbor>& result) const
+	{
+		if(n < 0) return;
+		const Node& node = nodes[n];
+		if((size_t)n != exclude)
+		{
+			double distance = (points[n] - query).squaredNorm();
+			if(result.size() < k)
+			{
+				result.push_back({distance, n});
+				std::push_heap(result.begin(), result.end());
+			}
+			else if(distance < result.front().first)
+			{
+				std::pop_heap(result.begin(), result.end());
+				result.back() = {distance, n};
+				std::push_heap(result.begin(), result.end());
+			}
+		}
+
+		double difference = query(node.axis) - points[n](node.axis);
+		search(difference < 0 ? node.left : node.right, query, k, exclude, result);
+		if(result.size() < k || difference*difference < result.front().first)
+			search(difference < 0 ? node.right : node.left, query, k, exclude, result);
+	}
+
+	std::vector<PointType> points;
+	std::vector<Node> nodes;
+	std::vector<int> path;
+	int root = -1;
+};
+
+/*
+ *  Novelty archive.
+ *
+ *  Novelty search (Lehman and Stanley, "Abandoning Objectives: Evolution Through the
+ *  Search for Novelty Alone") rewards behaving differently instead of scoring well. Each
+ *  network is summarized by a behavior descriptor, such as where the player ended up,
+ *  and its novelty is the mean distance to its k nearest neighbors among the archive
+ *  and the rest of the current population.
+ *
+ *  After every generation the behaviors more novel than threshold join the archive.
+ *  The threshold goes up by 20% when more than target_additions join at once and down by
+ *  5% after a generation where none do, which keeps the archive growing steadily.
+ *  Descriptors should be scaled so that every component spans a similar range.
+ */
+
+template <int Dim>
+class NoveltyArchive
+{
+public :
+	using BehaviorType = Eigen::Matrix<double, Dim, 1>;
+
+	NoveltyArchive(int k_ = 15, double threshold_ = 0.1, size_t target_additions_ = 8)
+		: k{k_}
+		, threshold{threshold_}
+		, target_additions{target_additions_}
+	{
+		assert(k > 0);
+	}
+
+	// The novelty of every behavior of a population, on number_of_threads threads.
+	std::vector<double> novelty(const std::vector<BehaviorType>& population, int number_of_threads = 1) const
+	{
+		TraceSpan span("novelty", "novelty", "archive", archive.size());
+		KDTree<Dim> neighbors(population);
+		std::vector<double> result(population.size());
+
+		auto block = [&](int t, int threads_used) {
+			std::vector<typename KDTree<Dim>::Neighbor> from_archive, from_population;
+			for(size_t i = population.size()*t/threads_used; i < population.size()*(t+1)/threads_used; ++i)
+			{
+				archive.nearest(population[i], k, from_archive);
+				neighbors.nearest(population[i], k, from_population, i);
+
+				// Both lists are sorted, so the k nearest overall are a merge of their fronts.
+				double sum = 0;
+				size_t a = 0, p = 0, count = 0;
+				for(; count < (size_t)k && (a < from_archive.size() || p < from_population.size()); ++count)
+				{
+					bool take_archive = p == from_population.size() || (a < from_archive.size() && from_archive[a].first < from_population[p].first);
+					sum += std::sqrt(take_archive ? from_archive[a++].first : from_population[p++].first);
+				}
+				result[i] = count ? sum/count : 0;
+			}
+		};
+
+		int threads_used = std::max(1, std::min<int>(number_of_threads, population.size()));
+		std::vector<std::thread> threads;
+		for(int t = 1; t < threads_used; ++t) threads.emplace_back(block, t, threads_used);
+		block(0, threads_used);
+		for(auto& thread : threads) thread.join();
+		return result;
+	}
+
+	// Adds the behaviors more novel than threshold and adapts the threshold. Returns the number added.
+	size_t update(const std::vector<BehaviorType>& population, const std::vector<double>& novelty)
+	{
+		assert(population.size() == novelty.size());
+		size_t added = 0;
+		for(size_t i = 0; i < population.size(); ++i)
+		{
+			if(novelty[i] <= threshold) continue;
+			archive.insert(population[i]);
+			++added;
+		}
+
+		if(added > target_additions) threshold *= 1.2;
+		else if(added == 0) threshold *= 0.95;
+		return added;
+	}
+
+	void add(const BehaviorType& behavior) { archive.insert(behavior); }
+
+	size_t size() const { return archive.size(); }
+	const KDTree<Dim>& get_archive() const { return archive; }
+
+public :
+	int k;
+	double threshold;
+	size_t target_additions;
+
+private :
+	KDTree<Dim> archive;
+};
+
+}
+
+#endif /* SRC_NOVELTY_ARCHIVE_HPP_ */
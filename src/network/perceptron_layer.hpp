@@ -16,28 +16,51 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <limits>
+#include <cstdint>
 #include "initialization.hpp"
 #include "concepts.hpp"
 
 namespace neural
 {
 
+// The weights as Scalar, in a temporary small enough to stay in cache. A bfloat16 is the
+// top half of a float, so widening one is a shift, which the compiler vectorizes; Eigen
+// converts bfloat16 and half one weight at a time.
+template <typename Scalar, typename Storage, int Rows, int Cols>
+Eigen::Matrix<Scalar, Rows, Cols> widen(const Eigen::Matrix<Storage, Rows, Cols>& weight)
+{
+	Eigen::Matrix<Scalar, Rows, Cols> res;
+	if constexpr (std::is_same_v<Storage, Eigen::bfloat16> && std::is_same_v<Scalar, float>)
+	{
+		for(int k = 0; k < weight.size(); ++k)
+			res.data()[k] = Eigen::numext::bit_cast<float>(uint32_t(weight.data()[k].value) << 16);
+	}
+	else res = weight.template cast<Scalar>();
+	return res;
+}
+
 /* Perceptron Layer */
 
-template < typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
+// Storage is the type the weights are kept as. Eigen::bfloat16 or Eigen::half halve the
+// bytes of a float layer; the weights are widened to Scalar as the kernel reads them.
+template < typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction, typename Storage = Scalar>
 class PerceptronLayer
 {
 public :
 	static_assert(NumInputs > 0 && NumOutputs > 0);
-	using ScalarType = Scalar;
+	using ScalarType  = Scalar;
+	using StorageType = Storage;
 	static constexpr int InputSize = NumInputs;
 	static constexpr int OutputSize = NumOutputs;
 	
 	static constexpr bool HasParameters = true;
+	static constexpr bool Compressed = !std::is_same_v<StorageType, ScalarType>;
 	
 	using InputType  = Eigen::Matrix<ScalarType, NumInputs, 1>;
 	using OutputType = Eigen::Matrix<ScalarType, NumOutputs, 1>;
-	using WeightType = Eigen::Matrix<ScalarType, NumOutputs, NumInputs>;
+	using WeightType = Eigen::Matrix<StorageType, NumOutputs, NumInputs>;
 	using Activation = ActivationFunction<ScalarType>;
 public :
 	PerceptronLayer() {}
@@ -46,44 +69,75 @@ public :
 	template <typename Initializer>
 	void initialize(Initializer& init) { init.initialize(*this); }
 	
-	inline OutputType feed_forward(const InputType& input) { return (weight*input).unaryExpr(&Activation::eval); }
+	inline OutputType feed_forward(const InputType& input) const
+	{
+		if constexpr (Compressed) return (widened()*input).unaryExpr(&Activation::eval);
+		else return (weight*input).unaryExpr(&Activation::eval);
+	}
+	
+	// One input per column, so a whole batch is a single matrix product.
+	template <int Cols>
+	inline Eigen::Matrix<ScalarType, NumOutputs, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, NumInputs, Cols>& input) const
+	{
+		if constexpr (Compressed) return (widened()*input).unaryExpr(&Activation::eval);
+		else return (weight*input).unaryExpr(&Activation::eval);
+	}
 	
 	inline WeightType& get_weight() { return weight; }
 	
 	inline const WeightType& get_weight() const { return weight; }
 	
 private :
+	Eigen::Matrix<ScalarType, NumOutputs, NumInputs> widened() const { return widen<ScalarType>(weight); }
+	
 	WeightType weight;
 };
 
-template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation>
-void read_from_file(std::ifstream& file, PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation>& layer)
+// Text format: one line per weight matrix, the weights row by row, comma separated. A
+// dynamic matrix has to have its shape already.
+
+template <typename Storage, int Rows, int Cols>
+void read_weights(std::ifstream& file, Eigen::Matrix<Storage, Rows, Cols>& weight)
 {
 	if(!file.is_open()) return;
 	std::string matrix_string;
 	getline(file, matrix_string);
 	std::stringstream matrix_stream(matrix_string);
 	std::string entry;
-	int number_of_parameters = NumInputs*NumOutputs;
+	int number_of_parameters = weight.size();
+	int cols = weight.cols();
 	
 	int i=0, r=0, c=0;
 	
 	while(std::getline(matrix_stream, entry, ','))
 	{
 		assert(i < number_of_parameters);
-		layer.get_weight()(r,c) = std::stod(entry);
-		r = r + (c+1)/NumInputs;
-		c = (c+1)%NumInputs;
+		weight(r,c) = static_cast<Storage>(std::stod(entry));
+		r = r + (c+1)/cols;
+		c = (c+1)%cols;
 		++i;
 	}
 	assert(i == number_of_parameters);
 }
 
-template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation>
-void save_to_file(std::ofstream& file, const PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation>& layer)
+template <typename Storage, int Rows, int Cols>
+void save_weights(std::ofstream& file, const Eigen::Matrix<Storage, Rows, Cols>& weight)
+{
+	// Enough digits to read back the same weights, whatever they are stored as.
+	Eigen::IOFormat CommaInitFmt(std::numeric_limits<Storage>::max_digits10, Eigen::DontAlignCols, ", ", ", ", "", "");
+	if(file.is_open()) file << weight.format(CommaInitFmt) << std::endl;
+}
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation, typename Storage>
+void read_from_file(std::ifstream& file, PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation, Storage>& layer)
 {
-	Eigen::IOFormat CommaInitFmt(Eigen::FullPrecision, Eigen::DontAlignCols, ", ", ", ", "", "");
-	if(file.is_open()) file << layer.get_weight().format(CommaInitFmt) << std::endl;
+	read_weights(file, layer.get_weight());
+}
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation, typename Storage>
+void save_to_file(std::ofstream& file, const PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation, Storage>& layer)
+{
+	save_weights(file, layer.get_weight());
 }
 
 /* Specializations */
@@ -97,10 +151,39 @@ using TanhLayer = PerceptronLayer<double, NumInputs, NumOutputs, tanh>;
 template <int NumInputs, int NumOutputs>
 using ReLULayer = PerceptronLayer<double, NumInputs, NumOutputs, ReLU>;
 
+template <int NumInputs, int NumOutputs>
+using SigmoidLayerF = PerceptronLayer<float, NumInputs, NumOutputs, sigmoid>;
+
+template <int NumInputs, int NumOutputs>
+using TanhLayerF = PerceptronLayer<float, NumInputs, NumOutputs, tanh>;
+
+template <int NumInputs, int NumOutputs>
+using ReLULayerF = PerceptronLayer<float, NumInputs, NumOutputs, ReLU>;
+
+// Float layers with 16 bit weights: bfloat16 keeps the range of float, half more digits.
+
+template <int NumInputs, int NumOutputs>
+using SigmoidLayerBF16 = PerceptronLayer<float, NumInputs, NumOutputs, sigmoid, Eigen::bfloat16>;
+
+template <int NumInputs, int NumOutputs>
+using TanhLayerBF16 = PerceptronLayer<float, NumInputs, NumOutputs, tanh, Eigen::bfloat16>;
+
+template <int NumInputs, int NumOutputs>
+using ReLULayerBF16 = PerceptronLayer<float, NumInputs, NumOutputs, ReLU, Eigen::bfloat16>;
+
+template <int NumInputs, int NumOutputs>
+using SigmoidLayerF16 = PerceptronLayer<float, NumInputs, NumOutputs, sigmoid, Eigen::half>;
+
+template <int NumInputs, int NumOutputs>
+using TanhLayerF16 = PerceptronLayer<float, NumInputs, NumOutputs, tanh, Eigen::half>;
+
+template <int NumInputs, int NumOutputs>
+using ReLULayerF16 = PerceptronLayer<float, NumInputs, NumOutputs, ReLU, Eigen::half>;
+
 /* Type Traits */
 
-template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
-constexpr bool is_layer<PerceptronLayer<Scalar, NumInputs, NumOutputs, ActivationFunction>> 	= true;
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction, typename Storage>
+constexpr bool is_layer<PerceptronLayer<Scalar, NumInputs, NumOutputs, ActivationFunction, Storage>> 	= true;
 
 template <int NumInputs, int NumOutputs>
 constexpr bool is_layer<SigmoidLayer<NumInputs, NumOutputs>	> 	= true;
@@ -14,8 +14,11 @@
 #include <cassert>
 #include <string>
 #include <fstream>
+#include <cstring>
 
 #include "perceptron_layer.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
 
 namespace neural
 {
@@ -153,6 +156,14 @@ public :
 	static constexpr int InputSize  = LayerType<0>::InputSize;
 	static constexpr int OutputSize = LayerType<number_of_layers-1>::OutputSize;
 	
+	// Hidden state of every recurrent layer, see step. Held by the caller, so networks with
+	// memory stay read-only and can be shared like any others.
+	using StateType = std::tuple<layer_state_t<Layers>...>;
+	static constexpr bool IsRecurrent = (recurrent_layer_type<Layers> || ...);
+	
+	// Size of the binary parameter format, see write_binary.
+	static constexpr size_t binary_size = (sizeof(typename Layers::WeightType) + ...);
+	
 	//using TrainingPolicy = GradientDescentPolicy;
 	//static constexpr bool UsesGradientDescent = !std::is_same_v<FeedbackwardPolicy::None, TrainingPolicy>;
 public :
@@ -170,21 +181,101 @@ public :
 private :
 	
 	template <size_t N>
-	OutputType feed_forward_to_final(const LInputType<N>& input)
+	OutputType feed_forward_to_final(const LInputType<N>& input) const
 	{
 		static_assert(N < number_of_layers && N >= 0);
 		
-		LOutputType<N> res = std::get<N>(layers).feed_forward(input);
+		LOutputType<N> res;
+		{
+			ProfileLayerScope scope(N);
+			TraceSpan span("feed_forward", "layer", "layer", N);
+			res = std::get<N>(layers).feed_forward(input);
+		}
 		if constexpr (N == number_of_layers-1) return res;
 		else return feed_forward_to_final<N+1>(res);
 	}
 	
+	template <size_t N, int Cols>
+	Eigen::Matrix<ScalarType, OutputSize, Cols> feed_forward_batch_to_final(const Eigen::Matrix<ScalarType, LayerType<N>::InputSize, Cols>& input) const
+	{
+		static_assert(N < number_of_layers && N >= 0);
+		
+		Eigen::Matrix<ScalarType, LayerType<N>::OutputSize, Cols> res;
+		{
+			ProfileLayerScope scope(N);
+			TraceSpan span("feed_forward_batch", "layer", "layer", N);
+			res = std::get<N>(layers).feed_forward_batch(input);
+		}
+		if constexpr (N == number_of_layers-1) return res;
+		else return feed_forward_batch_to_final<N+1>(res);
+	}
+	
+	template <size_t N>
+	OutputType step_to_final(const LInputType<N>& input, StateType& state) const
+	{
+		LOutputType<N> res;
+		{
+			ProfileLayerScope scope(N);
+			TraceSpan span("step", "layer", "layer", N);
+			if constexpr (recurrent_layer_type<LayerType<N>>) res = std::get<N>(layers).step(input, std::get<N>(state));
+			else res = std::get<N>(layers).feed_forward(input);
+		}
+		if constexpr (N == number_of_layers-1) return res;
+		else return step_to_final<N+1>(res, state);
+	}
+	
+	template <size_t N, int Steps>
+	Eigen::Matrix<ScalarType, OutputSize, Steps> feed_forward_sequence_to_final(const Eigen::Matrix<ScalarType, LayerType<N>::InputSize, Steps>& inputs, StateType& state) const
+	{
+		Eigen::Matrix<ScalarType, LayerType<N>::OutputSize, Steps> res;
+		{
+			ProfileLayerScope scope(N);
+			TraceSpan span("feed_forward_sequence", "layer", "layer", N);
+			if constexpr (recurrent_layer_type<LayerType<N>>) res = std::get<N>(layers).feed_forward_sequence(inputs, std::get<N>(state));
+			else res = std::get<N>(layers).feed_forward_batch(inputs);
+		}
+		if constexpr (N == number_of_layers-1) return res;
+		else return feed_forward_sequence_to_final<N+1>(res, state);
+	}
+	
 public :
-	OutputType feed_forward(const InputType& input)
+	// Recurrent layers start every feed_forward from a zero state, so without step a
+	// network with memory is a plain feed forward network.
+	OutputType feed_forward(const InputType& input) const
 	{
 		return feed_forward_to_final<0>(input);
 	}
 	
+	// Feeds every column of input through the network at once.
+	template <int Cols>
+	Eigen::Matrix<ScalarType, OutputSize, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, InputSize, Cols>& input) const
+	{
+		return feed_forward_batch_to_final<0>(input);
+	}
+	
+	// The state every episode starts from, all zeros.
+	static StateType initial_state()
+	{
+		StateType res;
+		std::apply([](auto&... s) { ((reset_state(s)), ...); }, res);
+		return res;
+	}
+	
+	// One tick of a network with memory: feeds input through and carries state over to the next tick.
+	OutputType step(const InputType& input, StateType& state) const
+	{
+		return step_to_final<0>(input, state);
+	}
+	
+	// A whole sequence at once, one column per tick, from state and leaving the state after
+	// the last tick. Every layer runs over the whole sequence before the next, so the inputs
+	// of a layer are all multiplied in one product and only the recurrence goes tick by tick.
+	template <int Steps>
+	Eigen::Matrix<ScalarType, OutputSize, Steps> feed_forward_sequence(const Eigen::Matrix<ScalarType, InputSize, Steps>& inputs, StateType& state) const
+	{
+		return feed_forward_sequence_to_final<0>(inputs, state);
+	}
+	
 	
 	
 	void operator=(NeuralNetwork<Layers...> other)
@@ -201,10 +292,39 @@ public :
 					}, layers);
 	}
 	
+	// Keyed by individual and layer index, see initialization.hpp.
+	template <typename Initializer>
+	void initialize(const Initializer& init, uint32_t individual)
+	{
+		uint32_t index = 0;
+		std::apply([&init, &index, individual](Layers&... l)
+					{
+						((init.initialize(l, individual, index++)), ...);
+					}, layers);
+	}
+	
 	std::tuple<Layers...> layers;
 	// Optimizer<TrainingPolicy> optimizer;
+	
+private :
+	static void reset_state(NoState&) {}
+	
+	template <typename S>
+	static void reset_state(S& s) { s.setZero(); }
 };
 
+// Calls f(index, layer) for every layer of the network, in order.
+
+template <typename NetworkType, typename F>
+void for_each_layer(NetworkType& nn, F f)
+{
+	size_t index = 0;
+	std::apply([&index, &f](auto&... layers)
+				{
+					((f(index++, layers)), ...);
+				}, nn.layers);
+}
+
 // Reading and writing functions.
 
 template <typename...Layers>
@@ -221,6 +341,32 @@ void save_to_file(std::ofstream& file, const NeuralNetwork<Layers...>& nn)
 				}, nn.layers);
 }
 
+// Binary parameter format: the weights of every layer in order, each column-major as raw
+// scalars, NeuralNetwork::binary_size bytes in all. For moving networks between processes
+// of the same build; it is not portable across machines.
+
+template <typename... Layers>
+size_t write_binary(char* buffer, const NeuralNetwork<Layers...>& nn)
+{
+	size_t offset = 0;
+	std::apply([buffer, &offset](const Layers&... layers)
+				{
+					((std::memcpy(buffer + offset, layers.get_weight().data(), sizeof(typename Layers::WeightType)), offset += sizeof(typename Layers::WeightType)), ...);
+				}, nn.layers);
+	return offset;
+}
+
+template <typename... Layers>
+size_t read_binary(const char* buffer, NeuralNetwork<Layers...>& nn)
+{
+	size_t offset = 0;
+	std::apply([buffer, &offset](Layers&... layers)
+				{
+					((std::memcpy(layers.get_weight().data(), buffer + offset, sizeof(typename Layers::WeightType)), offset += sizeof(typename Layers::WeightType)), ...);
+				}, nn.layers);
+	return offset;
+}
+
 template <typename... Layers>
 void read_from_file(std::ifstream& file, NeuralNetwork<Layers...>& nn)
 {
@@ -0,0 +1,230 @@
+/*
+ * population_statistics.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_POPULATION_STATISTICS_HPP_
+#define SRC_POPULATION_STATISTICS_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <utility>
+
+#include "plain_neural_network.hpp"
+#include "genome.hpp"
+
+namespace neural
+{
+
+/*
+ *  Population statistics.
+ *
+ *  One pass over a population of networks, or over a checkpoint written by save_to_file,
+ *  accumulating for every weight ("gene") a Welford running mean and sum of squared
+ *  deviations and a histogram over [-range, range] (values outside fall in the edge bins).
+ *  Partial results from different threads are combined with the pairwise update of
+ *  Chan et al., so the population can be split over any number of threads.
+ *
+ *  Per layer we report
+ *      mean      : mean of the gene means,
+ *      variance  : mean of the gene sample variances,
+ *      diversity : square root of the summed gene variances, the RMS distance of a
+ *                  network's layer to the population centroid,
+ *      entropy   : mean Shannon entropy of the gene histograms in bits, at most log2(Bins).
+ */
+
+template <typename NetworkType, int Bins = 16>
+class PopulationStatistics
+{
+public :
+	static constexpr size_t number_of_layers = NetworkType::number_of_layers;
+
+	struct LayerSummary {
+		size_t number_of_genes;
+		double mean;
+		double variance;
+		double diversity;
+		double entropy;
+	};
+
+	PopulationStatistics(double range_ = 4.0) : range{range_}
+	{
+		size_t n = 0;
+		NetworkType nn;
+		for_each_layer(nn, [this, &n](size_t l, const auto& layer) {
+			genes[l] = layer.get_weight().size();
+			offset[l] = n;
+			n += genes[l];
+		});
+		mean = Eigen::ArrayXd::Zero(n);
+		m2 = Eigen::ArrayXd::Zero(n);
+		histogram = HistogramType::Zero(Bins, n);
+	}
+
+	void clear()
+	{
+		mean.setZero();
+		m2.setZero();
+		histogram.setZero();
+		count = 0;
+	}
+
+	void add(const NetworkType& nn)
+	{
+		++count;
+		for_each_layer(nn, [this](size_t l, const auto& layer) {
+			const auto& w = layer.get_weight();
+			auto x = Eigen::Map<const Eigen::Array<typename std::decay_t<decltype(w)>::Scalar, Eigen::Dynamic, 1>>(w.data(), w.size()).template cast<double>();
+			auto mu = mean.segment(offset[l], genes[l]);
+			Eigen::ArrayXd delta = x - mu;
+			mu += delta / count;
+			m2.segment(offset[l], genes[l]) += delta * (x - mu);
+
+			for(size_t g = 0; g < genes[l]; ++g)
+			{
+				int bin = (int)std::floor((x(g) + range) * Bins / (2*range));
+				++histogram(std::clamp(bin, 0, Bins-1), offset[l] + g);
+			}
+		});
+	}
+
+	void merge(const PopulationStatistics& other)
+	{
+		if(other.count == 0) return;
+		double n = count + other.count;
+		Eigen::ArrayXd delta = other.mean - mean;
+		mean += delta * (other.count / n);
+		m2 += other.m2 + delta.square() * (count * (double)other.count / n);
+		histogram += other.histogram;
+		count += other.count;
+	}
+
+	LayerSummary summary(size_t l) const
+	{
+		assert(l < number_of_layers);
+		LayerSummary s {genes[l], 0, 0, 0, 0};
+		if(count == 0) return s;
+
+		auto mu = mean.segment(offset[l], genes[l]);
+		Eigen::ArrayXd variance = m2.segment(offset[l], genes[l]) / std::max<double>(count - 1, 1);
+		s.mean = mu.mean();
+		s.variance = variance.mean();
+		s.diversity = std::sqrt(variance.sum());
+
+		Eigen::ArrayXXd p = histogram.middleCols(offset[l], genes[l]).template cast<double>() / count;
+		s.entropy = -(p * (p > 0).select(p.log() / std::log(2.0), 0)).colwise().sum().mean();
+		return s;
+	}
+
+	std::array<LayerSummary, number_of_layers> summaries() const
+	{
+		std::array<LayerSummary, number_of_layers> res;
+		for(size_t l = 0; l < number_of_layers; ++l) res[l] = summary(l);
+		return res;
+	}
+
+	// Per gene, in the order of the weights of each layer (column-major), layer after layer.
+	const Eigen::ArrayXd& gene_means() const { return mean; }
+	Eigen::ArrayXd gene_variances() const { return m2 / std::max<double>(count - 1, 1); }
+
+	size_t size() const { return count; }
+
+private :
+	using HistogramType = Eigen::Array<uint32_t, Bins, Eigen::Dynamic>;
+
+	double range;
+	size_t count = 0;
+	std::array<size_t, number_of_layers> genes;
+	std::array<size_t, number_of_layers> offset;
+	Eigen::ArrayXd mean;
+	Eigen::ArrayXd m2;
+	HistogramType histogram;
+};
+
+// Statistics of the networks of a genetic algorithm population, split over number_of_threads threads.
+template <typename NetworkType, typename ScoreType, int Bins = 16>
+PopulationStatistics<NetworkType, Bins> population_statistics(
+	const std::vector<std::pair<Genome<NetworkType>, ScoreType>>& population,
+	int number_of_threads = 1,
+	double range = 4.0)
+{
+	assert(number_of_threads > 0);
+	size_t n = population.size();
+	std::vector<PopulationStatistics<NetworkType, Bins>> partial(number_of_threads, PopulationStatistics<NetworkType, Bins>(range));
+
+	auto accumulate = [&](int t) {
+		for(size_t i = n*t/number_of_threads; i < n*(t+1)/number_of_threads; ++i) partial[t].add(*population[i].first);
+	};
+
+	if(number_of_threads == 1) accumulate(0);
+	else
+	{
+		std::vector<std::thread> threads;
+		for(int t = 0; t < number_of_threads; ++t) threads.emplace_back(accumulate, t);
+		for(auto& thread : threads) thread.join();
+	}
+
+	for(int t = 1; t < number_of_threads; ++t) partial[0].merge(partial[t]);
+	return partial[0];
+}
+
+// Streams the networks of a checkpoint: a first line with the generation, then the networks as
+// written by save_to_file. Only one network is held in memory at a time.
+template <typename NetworkType, int Bins = 16>
+bool checkpoint_statistics(const std::string& filename, PopulationStatistics<NetworkType, Bins>& statistics, int* generation = nullptr)
+{
+	std::ifstream file(filename);
+	if(!file.is_open())
+	{
+		std::cout << "File not open. Cannot be read." << std::endl;
+		return false;
+	}
+
+	std::string line;
+	std::getline(file, line);
+	if(generation) *generation = std::atoi(line.c_str());
+
+	NetworkType nn;
+	while((file >> std::ws).peek() != std::ifstream::traits_type::eof())
+	{
+		read_from_file(file, nn);
+		statistics.add(nn);
+	}
+	return true;
+}
+
+template <typename NetworkType, int Bins>
+void print(std::ostream& out, const PopulationStatistics<NetworkType, Bins>& statistics)
+{
+	out << std::left << std::setw(7) << "layer" << std::right
+		<< std::setw(7) << "genes"
+		<< std::setw(13) << "mean"
+		<< std::setw(13) << "variance"
+		<< std::setw(13) << "diversity"
+		<< std::setw(13) << "entropy" << std::endl;
+	auto summaries = statistics.summaries();
+	for(size_t l = 0; l < summaries.size(); ++l)
+	{
+		out << std::left << std::setw(7) << l << std::right
+			<< std::setw(7) << summaries[l].number_of_genes
+			<< std::setw(13) << summaries[l].mean
+			<< std::setw(13) << summaries[l].variance
+			<< std::setw(13) << summaries[l].diversity
+			<< std::setw(13) << summaries[l].entropy << std::endl;
+	}
+}
+
+}
+
+#endif /* SRC_POPULATION_STATISTICS_HPP_ */
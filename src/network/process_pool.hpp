@@ -0,0 +1,343 @@
+/*
+ * process_pool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_PROCESS_POOL_HPP_
+#define SRC_PROCESS_POOL_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+#include <type_traits>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "plain_neural_network.hpp"
+#include "trace.hpp"
+
+namespace neural
+{
+
+/*
+ *  Process pool.
+ *
+ *  Scores networks in forked worker processes, so a scorer that crashes, leaks or holds
+ *  global state stays out of the trainer. Every worker is connected to the coordinator by
+ *  a Unix domain socket pair.
+ *
+ *      request : batch:u32 count:u32, then count times index:u32 and the network in the
+ *                binary parameter format (write_binary)
+ *      reply   : batch:u32 count:u32, then count times index:u32 and the score
+ *
+ *  Networks are sent batch_size at a time and each worker has up to pipeline_depth
+ *  batches in flight, so it never waits on the coordinator between batches. When a
+ *  worker dies, its batches in flight are sent again and a new worker is forked in its
+ *  place.
+ *
+ *  The workers are forked when the pool is made and run a copy of the scorer as it was
+ *  then. Scores must be trivially copyable.
+ */
+
+namespace process_pool_detail
+{
+
+// A dead worker must not kill the coordinator with SIGPIPE. Linux has MSG_NOSIGNAL, macOS
+// the SO_NOSIGPIPE socket option set in spawn().
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+inline bool write_all(int fd, const char* data, size_t size)
+{
+	while(size > 0)
+	{
+		ssize_t n = send(fd, data, size, send_flags);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+inline bool read_all(int fd, char* data, size_t size)
+{
+	while(size > 0)
+	{
+		ssize_t n = read(fd, data, size);
+		if(n < 0 && errno == EINTR) continue;
+		if(n <= 0) return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+struct Header {
+	uint32_t batch;
+	uint32_t count;
+};
+
+}
+
+template <typename ScorerT, typename NN>
+class ProcessPool
+{
+public :
+	using NetworkType = NN;
+	using ScoreType   = typename ScorerT::OutputType;
+	static_assert(std::is_trivially_copyable_v<ScoreType>);
+
+	ProcessPool(const ScorerT& scorer_, int number_of_workers, int batch_size_ = 8, int pipeline_depth_ = 2)
+		: scorer{scorer_}
+		, batch_size{batch_size_}
+		, pipeline_depth{pipeline_depth_}
+		, workers(number_of_workers)
+	{
+		assert(number_of_workers > 0 && batch_size > 0 && pipeline_depth > 0);
+		for(size_t w = 0; w < workers.size(); ++w) spawn(w);
+	}
+
+	ProcessPool(const ProcessPool&) = delete;
+	ProcessPool& operator=(const ProcessPool&) = delete;
+
+	~ProcessPool()
+	{
+		for(size_t w = 0; w < workers.size(); ++w) stop(w);
+	}
+
+	// Scores every network of the population and stores the scores in it.
+	template <typename PopulationType>
+	void evaluate(std::vector<PopulationType>& population)
+	{
+		TraceSpan span("process pool", "workers", "population", population.size());
+		using namespace process_pool_detail;
+
+		std::vector<Batch> batches;
+		for(size_t first = 0; first < population.size(); first += batch_size)
+			batches.push_back({first, std::min(population.size(), first + batch_size)});
+		std::deque<uint32_t> queue;
+		for(uint32_t b = 0; b < batches.size(); ++b) queue.push_back(b);
+		size_t remaining = batches.size();
+
+		std::vector<char> message;
+		auto send_batch = [&](size_t w, uint32_t b) {
+			const Batch& batch = batches[b];
+			Header header {b, (uint32_t)(batch.end - batch.begin)};
+			message.resize(sizeof(Header) + header.count*(sizeof(uint32_t) + NetworkType::binary_size));
+			std::memcpy(message.data(), &header, sizeof(Header));
+			char* p = message.data() + sizeof(Header);
+			for(size_t i = batch.begin; i < batch.end; ++i)
+			{
+				uint32_t index = i;
+				std::memcpy(p, &index, sizeof(index));
+				p += sizeof(index);
+				p += write_binary(p, *population[i].first);
+			}
+			workers[w].in_flight.push_back(b);
+			return write_all(workers[w].fd, message.data(), message.size());
+		};
+
+		// A batch that takes down max_attempts workers is given up and scored ScoreType{}.
+		std::vector<int> attempts(batches.size(), 0);
+		auto fail = [&](size_t w) {
+			std::cout << "Worker " << workers[w].pid << " failed, resubmitting " << workers[w].in_flight.size() << " batches." << std::endl;
+			for(uint32_t b : workers[w].in_flight)
+			{
+				if(++attempts[b] < max_attempts)
+				{
+					queue.push_front(b);
+					continue;
+				}
+				std::cout << "Giving up on networks " << batches[b].begin << " to " << batches[b].end-1 << "." << std::endl;
+				for(size_t i = batches[b].begin; i < batches[b].end; ++i) population[i].second = ScoreType{};
+				--remaining;
+			}
+			workers[w].in_flight.clear();
+			stop(w);
+			spawn(w);
+			++number_of_failures;
+		};
+
+		while(remaining > 0)
+		{
+			// Without any worker left, score what is left here.
+			if(std::none_of(workers.begin(), workers.end(), [](const Worker& w) { return w.fd >= 0; }))
+			{
+				std::cout << "No worker processes, scoring in the coordinator." << std::endl;
+				for(uint32_t b : queue)
+					for(size_t i = batches[b].begin; i < batches[b].end; ++i) population[i].second = scorer(*population[i].first);
+				return;
+			}
+
+			for(size_t w = 0; w < workers.size(); ++w)
+				while(workers[w].fd >= 0 && !queue.empty() && (int)workers[w].in_flight.size() < pipeline_depth)
+				{
+					uint32_t b = queue.front();
+					queue.pop_front();
+					if(!send_batch(w, b))
+					{
+						fail(w);
+						break;
+					}
+				}
+
+			std::vector<pollfd> fds(workers.size());
+			for(size_t w = 0; w < workers.size(); ++w) fds[w] = {workers[w].fd, POLLIN, 0};
+			if(poll(fds.data(), fds.size(), -1) < 0)
+			{
+				if(errno == EINTR) continue;
+				std::cout << "poll failed." << std::endl;
+				return;
+			}
+
+			for(size_t w = 0; w < workers.size(); ++w)
+			{
+				if(fds[w].fd < 0 || !(fds[w].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+				Header header;
+				bool ok = read_all(workers[w].fd, (char*)&header, sizeof(header))
+					&& !workers[w].in_flight.empty() && header.batch == workers[w].in_flight.front();
+				if(ok)
+				{
+					message.resize(header.count*(sizeof(uint32_t) + sizeof(ScoreType)));
+					ok = read_all(workers[w].fd, message.data(), message.size());
+				}
+				if(!ok)
+				{
+					fail(w);
+					continue;
+				}
+
+				const char* p = message.data();
+				for(uint32_t k = 0; k < header.count; ++k)
+				{
+					uint32_t index;
+					std::memcpy(&index, p, sizeof(index));
+					std::memcpy(&population[index].second, p + sizeof(index), sizeof(ScoreType));
+					p += sizeof(index) + sizeof(ScoreType);
+				}
+				workers[w].in_flight.pop_front();
+				--remaining;
+			}
+		}
+	}
+
+	size_t size() const { return workers.size(); }
+
+	int number_of_failures = 0;
+	int max_attempts = 3;
+
+private :
+	struct Batch {
+		size_t begin;
+		size_t end;
+	};
+
+	struct Worker {
+		pid_t pid = -1;
+		int fd = -1;
+		std::deque<uint32_t> in_flight;
+	};
+
+	void spawn(size_t w)
+	{
+		int fds[2];
+		if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+		{
+			std::cout << "socketpair failed." << std::endl;
+			return;
+		}
+
+		pid_t pid = fork();
+		if(pid == 0)
+		{
+			// Only this thread exists in the child, so tracing must not wait on the flusher.
+			trace_detail::Tracer::instance().enabled.store(false);
+			close(fds[0]);
+			for(const Worker& other : workers) if(other.fd >= 0) close(other.fd);
+			serve(fds[1]);
+			_exit(0);
+		}
+
+		close(fds[1]);
+#ifdef SO_NOSIGPIPE
+		int one = 1;
+		setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+		if(pid < 0)
+		{
+			std::cout << "fork failed." << std::endl;
+			close(fds[0]);
+			return;
+		}
+		workers[w].pid = pid;
+		workers[w].fd = fds[0];
+	}
+
+	void stop(size_t w)
+	{
+		if(workers[w].fd >= 0) close(workers[w].fd);
+		if(workers[w].pid > 0)
+		{
+			kill(workers[w].pid, SIGTERM);
+			waitpid(workers[w].pid, nullptr, 0);
+		}
+		workers[w].fd = -1;
+		workers[w].pid = -1;
+	}
+
+	// Worker loop: answers requests until the coordinator closes the socket.
+	void serve(int fd)
+	{
+		using namespace process_pool_detail;
+		std::vector<char> request, reply;
+		NetworkType nn;
+		Header header;
+		while(read_all(fd, (char*)&header, sizeof(header)))
+		{
+			request.resize(header.count*(sizeof(uint32_t) + NetworkType::binary_size));
+			if(!read_all(fd, request.data(), request.size())) return;
+
+			reply.resize(sizeof(Header) + header.count*(sizeof(uint32_t) + sizeof(ScoreType)));
+			std::memcpy(reply.data(), &header, sizeof(Header));
+			const char* in = request.data();
+			char* out = reply.data() + sizeof(Header);
+			for(uint32_t k = 0; k < header.count; ++k)
+			{
+				std::memcpy(out, in, sizeof(uint32_t));
+				in += sizeof(uint32_t);
+				in += read_binary(in, nn);
+				ScoreType score = scorer(nn);
+				std::memcpy(out + sizeof(uint32_t), &score, sizeof(ScoreType));
+				out += sizeof(uint32_t) + sizeof(ScoreType);
+			}
+			if(!write_all(fd, reply.data(), reply.size())) return;
+		}
+	}
+
+	ScorerT scorer;
+	int batch_size;
+	int pipeline_depth;
+	std::vector<Worker> workers;
+};
+
+}
+
+#endif /* SRC_PROCESS_POOL_HPP_ */
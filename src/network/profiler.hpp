@@ -0,0 +1,327 @@
+/*
+ * profiler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_PROFILER_HPP_
+#define SRC_PROFILER_HPP_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#if defined(NEURAL_PROFILE_TSC) && (defined(__x86_64__) || defined(__i386__))
+	#include <x86intrin.h>
+#endif
+
+namespace neural
+{
+
+/*
+ *  Profiler.
+ *
+ *  Accumulates time and call counts per phase of a generation and per layer of
+ *  feed_forward. Compile with -DNEURAL_PROFILE to enable it; otherwise every scope is
+ *  empty and compiles away. With -DNEURAL_PROFILE_TSC on x86 the time stamp counter is
+ *  read instead of steady_clock and converted to seconds against steady_clock.
+ *
+ *  Every thread owns its counters, which it updates without atomic read-modify-writes.
+ *  profile_snapshot() sums the counters of all live threads and of threads that exited.
+ *
+ *      {
+ *          ProfileScope scope(ProfilePhase::Sort);
+ *          ...
+ *      }
+ */
+
+#ifdef NEURAL_PROFILE
+constexpr bool profiling = true;
+#else
+constexpr bool profiling = false;
+#endif
+
+enum class ProfilePhase : int {
+	Evaluation,
+	Sort,
+	Selection,
+	Crossover,
+	Mutation,
+	Telemetry,
+	Count
+};
+
+inline const char* profile_phase_name(ProfilePhase phase)
+{
+	static constexpr const char* names[] = {"evaluation", "sort_by_scores", "selection", "get_child", "mutate", "telemetry"};
+	return names[(int)phase];
+}
+
+static constexpr int number_of_profile_phases = (int)ProfilePhase::Count;
+static constexpr int max_profiled_layers = 16;
+
+/* Snapshot */
+
+struct ProfileSnapshot {
+	struct Entry {
+		uint64_t calls = 0;
+		double seconds = 0;
+	};
+
+	std::array<Entry, number_of_profile_phases> phases {};
+	std::array<Entry, max_profiled_layers> layers {};
+
+	ProfileSnapshot operator-(const ProfileSnapshot& other) const
+	{
+		ProfileSnapshot res;
+		for(int i = 0; i < number_of_profile_phases; ++i)
+			res.phases[i] = {phases[i].calls - other.phases[i].calls, phases[i].seconds - other.phases[i].seconds};
+		for(int i = 0; i < max_profiled_layers; ++i)
+			res.layers[i] = {layers[i].calls - other.layers[i].calls, layers[i].seconds - other.layers[i].seconds};
+		return res;
+	}
+
+	const Entry& operator[](ProfilePhase phase) const { return phases[(int)phase]; }
+};
+
+namespace profiler_detail
+{
+
+inline uint64_t steady_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(NEURAL_PROFILE_TSC) && (defined(__x86_64__) || defined(__i386__))
+inline uint64_t ticks() { return __rdtsc(); }
+#else
+inline uint64_t ticks() { return steady_ns(); }
+#endif
+
+struct Counters {
+	std::array<std::atomic<uint64_t>, number_of_profile_phases> phase_calls {};
+	std::array<std::atomic<uint64_t>, number_of_profile_phases> phase_ticks {};
+	std::array<std::atomic<uint64_t>, max_profiled_layers> layer_calls {};
+	std::array<std::atomic<uint64_t>, max_profiled_layers> layer_ticks {};
+};
+
+// Only the owning thread writes its counters, so a relaxed load and store is enough and
+// readers never see a torn value.
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void clear(Counters& c)
+{
+	for(auto& x : c.phase_calls) x.store(0, std::memory_order_relaxed);
+	for(auto& x : c.phase_ticks) x.store(0, std::memory_order_relaxed);
+	for(auto& x : c.layer_calls) x.store(0, std::memory_order_relaxed);
+	for(auto& x : c.layer_ticks) x.store(0, std::memory_order_relaxed);
+}
+
+inline void fold(Counters& into, const Counters& from)
+{
+	for(int i = 0; i < number_of_profile_phases; ++i)
+	{
+		bump(into.phase_calls[i], from.phase_calls[i].load(std::memory_order_relaxed));
+		bump(into.phase_ticks[i], from.phase_ticks[i].load(std::memory_order_relaxed));
+	}
+	for(int i = 0; i < max_profiled_layers; ++i)
+	{
+		bump(into.layer_calls[i], from.layer_calls[i].load(std::memory_order_relaxed));
+		bump(into.layer_ticks[i], from.layer_ticks[i].load(std::memory_order_relaxed));
+	}
+}
+
+struct Registry {
+	std::mutex mutex;
+	std::vector<Counters*> threads;
+	Counters retired;
+	uint64_t start_ticks = ticks();
+	uint64_t start_ns = steady_ns();
+
+	static Registry& instance()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	double seconds_per_tick()
+	{
+#if defined(NEURAL_PROFILE_TSC) && (defined(__x86_64__) || defined(__i386__))
+		uint64_t elapsed_ticks = ticks() - start_ticks;
+		uint64_t elapsed_ns = steady_ns() - start_ns;
+		return elapsed_ticks ? 1e-9 * elapsed_ns / elapsed_ticks : 0;
+#else
+		return 1e-9;
+#endif
+	}
+};
+
+struct ThreadCounters {
+	ThreadCounters()
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.threads.push_back(&counters);
+	}
+
+	~ThreadCounters()
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		fold(registry.retired, counters);
+		registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), &counters));
+	}
+
+	Counters counters;
+};
+
+inline Counters& local()
+{
+	static thread_local ThreadCounters thread_counters;
+	return thread_counters.counters;
+}
+
+}
+
+/* Scopes */
+
+class ProfileScope
+{
+public :
+	ProfileScope(ProfilePhase phase_) : phase{(int)phase_}
+	{
+		if constexpr (profiling) start = profiler_detail::ticks();
+	}
+
+	~ProfileScope()
+	{
+		if constexpr (profiling)
+		{
+			profiler_detail::Counters& c = profiler_detail::local();
+			profiler_detail::bump(c.phase_ticks[phase], profiler_detail::ticks() - start);
+			profiler_detail::bump(c.phase_calls[phase], 1);
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private :
+	int phase;
+	uint64_t start = 0;
+};
+
+// Layers past max_profiled_layers are counted in the last slot.
+class ProfileLayerScope
+{
+public :
+	ProfileLayerScope(size_t layer_) : layer{(int)std::min<size_t>(layer_, max_profiled_layers-1)}
+	{
+		if constexpr (profiling) start = profiler_detail::ticks();
+	}
+
+	~ProfileLayerScope()
+	{
+		if constexpr (profiling)
+		{
+			profiler_detail::Counters& c = profiler_detail::local();
+			profiler_detail::bump(c.layer_ticks[layer], profiler_detail::ticks() - start);
+			profiler_detail::bump(c.layer_calls[layer], 1);
+		}
+	}
+
+	ProfileLayerScope(const ProfileLayerScope&) = delete;
+	ProfileLayerScope& operator=(const ProfileLayerScope&) = delete;
+
+private :
+	int layer;
+	uint64_t start = 0;
+};
+
+/* API */
+
+// Totals over all threads since the start of the program, or the last profile_reset().
+inline ProfileSnapshot profile_snapshot()
+{
+	ProfileSnapshot res;
+	if constexpr (!profiling) return res;
+
+	profiler_detail::Registry& registry = profiler_detail::Registry::instance();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	profiler_detail::Counters total;
+	profiler_detail::fold(total, registry.retired);
+	for(profiler_detail::Counters* c : registry.threads) profiler_detail::fold(total, *c);
+
+	double seconds_per_tick = registry.seconds_per_tick();
+	for(int i = 0; i < number_of_profile_phases; ++i)
+		res.phases[i] = {total.phase_calls[i].load(), total.phase_ticks[i].load() * seconds_per_tick};
+	for(int i = 0; i < max_profiled_layers; ++i)
+		res.layers[i] = {total.layer_calls[i].load(), total.layer_ticks[i].load() * seconds_per_tick};
+	return res;
+}
+
+// Clears the counters of exited threads and of the calling thread. Other live threads keep
+// theirs. A ProfileReport created before a reset reports nonsense deltas afterwards.
+inline void profile_reset()
+{
+	if constexpr (!profiling) return;
+	profiler_detail::Registry& registry = profiler_detail::Registry::instance();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	profiler_detail::clear(registry.retired);
+	profiler_detail::clear(profiler_detail::local());
+}
+
+// Leaves the flags and precision of out as they were.
+inline void print(std::ostream& out, const ProfileSnapshot& snapshot)
+{
+	auto flags = out.flags();
+	auto precision = out.precision();
+	auto line = [&out](const std::string& name, const ProfileSnapshot::Entry& e) {
+		if(e.calls == 0) return;
+		out << "  " << std::left << std::setw(16) << name << std::right
+			<< std::setw(12) << e.calls
+			<< std::setw(12) << std::fixed << std::setprecision(3) << 1e3 * e.seconds << " ms"
+			<< std::setw(12) << std::setprecision(1) << 1e9 * e.seconds / e.calls << " ns/call" << std::endl;
+	};
+	for(int i = 0; i < number_of_profile_phases; ++i) line(profile_phase_name((ProfilePhase)i), snapshot.phases[i]);
+	for(int i = 0; i < max_profiled_layers; ++i) line("layer " + std::to_string(i), snapshot.layers[i]);
+	out.flags(flags);
+	out.precision(precision);
+}
+
+// Prints what was recorded since the previous dump every period generations.
+class ProfileReport
+{
+public :
+	ProfileReport(int period_ = 1, std::ostream& out_ = std::cout) : period{period_}, out{out_} {}
+
+	void generation_done(int generation)
+	{
+		if constexpr (!profiling) return;
+		if(period <= 0 || generation % period != 0) return;
+		ProfileSnapshot now = profile_snapshot();
+		out << "Profile, generation " << generation << ":" << std::endl;
+		print(out, now - last);
+		last = now;
+	}
+
+private :
+	int period;
+	std::ostream& out;
+	ProfileSnapshot last;
+};
+
+}
+
+#endif /* SRC_PROFILER_HPP_ */
@@ -0,0 +1,122 @@
+/*
+ * pruning.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_PRUNING_HPP_
+#define SRC_PRUNING_HPP_
+
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "plain_neural_network.hpp"
+
+namespace neural
+{
+
+/*
+ *  Magnitude pruning.
+ *
+ *  Zeroes the weights smallest in absolute value, either below a threshold or the
+ *  given fraction of them, over the whole network (global) or layer by layer. Evolved
+ *  networks carry many weights close to 0 that change the outputs very little; once
+ *  they are exactly 0, sparse_layer.hpp can skip them.
+ *
+ *  Every function returns the number of weights zeroed, counting those already 0.
+ */
+
+namespace pruning_detail
+{
+	template <typename WeightT>
+	double magnitude(const WeightT& w, int k) { return std::abs(static_cast<double>(w.data()[k])); }
+
+	// The magnitude below which fraction of magnitudes lie.
+	inline double quantile(std::vector<double>& magnitudes, double fraction)
+	{
+		if(magnitudes.empty() || fraction <= 0) return 0;
+		size_t count = std::min(magnitudes.size(), (size_t)std::ceil(fraction * magnitudes.size()));
+		std::nth_element(magnitudes.begin(), magnitudes.begin() + (count-1), magnitudes.end());
+		return magnitudes[count-1];
+	}
+
+	// Zeroes the weights of layer with magnitude at most threshold (below it, with strict).
+	template <typename LayerT>
+	size_t zero_below(LayerT& layer, double threshold, bool strict)
+	{
+		auto& w = layer.get_weight();
+		using StorageType = typename std::decay_t<decltype(w)>::Scalar;
+		size_t zeroed = 0;
+		for(int k = 0; k < w.size(); ++k)
+		{
+			double m = magnitude(w, k);
+			if(strict ? m < threshold : m <= threshold)
+			{
+				w.data()[k] = StorageType(0);
+				++zeroed;
+			}
+		}
+		return zeroed;
+	}
+}
+
+// Zeroes every weight smaller than threshold in absolute value.
+template <typename... Layers>
+size_t prune_by_magnitude(NeuralNetwork<Layers...>& nn, double threshold)
+{
+	size_t zeroed = 0;
+	for_each_layer(nn, [&](size_t, auto& layer) { zeroed += pruning_detail::zero_below(layer, threshold, true); });
+	return zeroed;
+}
+
+// Zeroes the fraction of all the weights of the network smallest in absolute value.
+template <typename... Layers>
+size_t prune_fraction(NeuralNetwork<Layers...>& nn, double fraction)
+{
+	assert(fraction >= 0 && fraction <= 1);
+	std::vector<double> magnitudes;
+	for_each_layer(nn, [&](size_t, const auto& layer) {
+		const auto& w = layer.get_weight();
+		for(int k = 0; k < w.size(); ++k) magnitudes.push_back(pruning_detail::magnitude(w, k));
+	});
+	if(fraction <= 0) return 0;
+	double threshold = pruning_detail::quantile(magnitudes, fraction);
+
+	size_t zeroed = 0;
+	for_each_layer(nn, [&](size_t, auto& layer) { zeroed += pruning_detail::zero_below(layer, threshold, false); });
+	return zeroed;
+}
+
+// Zeroes the fraction of the weights of every layer smallest in absolute value, so every layer ends up equally sparse.
+template <typename... Layers>
+size_t prune_fraction_per_layer(NeuralNetwork<Layers...>& nn, double fraction)
+{
+	assert(fraction >= 0 && fraction <= 1);
+	if(fraction <= 0) return 0;
+	size_t zeroed = 0;
+	for_each_layer(nn, [&](size_t, auto& layer) {
+		const auto& w = layer.get_weight();
+		std::vector<double> magnitudes(w.size());
+		for(int k = 0; k < w.size(); ++k) magnitudes[k] = pruning_detail::magnitude(w, k);
+		zeroed += pruning_detail::zero_below(layer, pruning_detail::quantile(magnitudes, fraction), false);
+	});
+	return zeroed;
+}
+
+// Fraction of the weights of layer that are not 0.
+template <typename LayerT>
+double density(const LayerT& layer)
+{
+	const auto& w = layer.get_weight();
+	size_t nonzero = 0;
+	for(int k = 0; k < w.size(); ++k) nonzero += pruning_detail::magnitude(w, k) != 0;
+	return w.size() ? (double)nonzero/w.size() : 0;
+}
+
+}
+
+#endif /* SRC_PRUNING_HPP_ */
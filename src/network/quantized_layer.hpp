@@ -0,0 +1,221 @@
+/*
+ * quantized_layer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_QUANTIZED_LAYER_HPP_
+#define SRC_QUANTIZED_LAYER_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <array>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "concepts.hpp"
+#include "perceptron_layer.hpp"
+#include "plain_neural_network.hpp"
+
+namespace neural
+{
+
+/*
+ *  Quantized layer.
+ *
+ *  An inference-only PerceptronLayer with int8 weights. Row r of the weights is
+ *  scale(r) * q(r, .) with q in [-127, 127], and the input is quantized to int8 with one
+ *  scale for the layer, found by calibrate(). The products are summed in int32, scaled
+ *  back to float, and the activation is applied in float, so each layer quantizes its
+ *  own input and the layers chain like any others.
+ *
+ *  The weights are stored row-major with every row padded with zeros to a multiple of
+ *  32, so a row is a whole number of AVX2 registers. With AVX2 the dot products use
+ *  vpmaddubsw: it multiplies unsigned by signed bytes, so the sign of the input is
+ *  moved onto the weight first. Keeping both in [-127, 127] means a pair of products
+ *  never saturates the int16 sums. With AVX-VNNI, vpdpbusd does the same multiply and
+ *  adds straight into int32. Without AVX2, and for the last rows when there are
+ *  not four left, a plain loop computes the same sums.
+ */
+
+template <int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
+class QuantizedLayer
+{
+public :
+	static_assert(NumInputs > 0 && NumOutputs > 0);
+	using ScalarType = float;
+	static constexpr int InputSize = NumInputs;
+	static constexpr int OutputSize = NumOutputs;
+	static constexpr int PaddedInputs = (NumInputs + 31)/32*32;
+
+	static constexpr bool HasParameters = false;
+
+	using InputType  = Eigen::Matrix<ScalarType, NumInputs, 1>;
+	using OutputType = Eigen::Matrix<ScalarType, NumOutputs, 1>;
+	using WeightType = Eigen::Matrix<int8_t, NumOutputs, PaddedInputs, Eigen::RowMajor>;
+	using ScaleType  = Eigen::Matrix<ScalarType, NumOutputs, 1>;
+	using Activation = ActivationFunction<ScalarType>;
+
+public :
+	QuantizedLayer() : weight{WeightType::Zero()}, row_scale{ScaleType::Zero()} {}
+
+	// Quantizes the weights of a trained layer, one scale per row. The input scale is 1 until calibrated.
+	template <typename Scalar, template<typename> class A, typename Storage>
+	explicit QuantizedLayer(const PerceptronLayer<Scalar, NumInputs, NumOutputs, A, Storage>& layer)
+		: QuantizedLayer()
+	{
+		Eigen::Matrix<double, NumOutputs, NumInputs> w = layer.get_weight().template cast<double>();
+		for(int r = 0; r < NumOutputs; ++r)
+		{
+			double largest = w.row(r).cwiseAbs().maxCoeff();
+			row_scale(r) = (largest > 0) ? largest/127 : 1;
+			for(int c = 0; c < NumInputs; ++c)
+				weight(r, c) = (int8_t)std::clamp<long>(std::lround(w(r, c)/row_scale(r)), -127, 127);
+		}
+	}
+
+	// Inputs up to largest in absolute value are represented, larger ones are clamped.
+	void set_input_range(double largest) { input_scale = (largest > 0) ? largest/127 : 1; }
+
+	OutputType feed_forward(const InputType& input) const
+	{
+		// Eigen converts float to int8 one element at a time, to int32 a register at a time.
+		Eigen::Array<int32_t, NumInputs, 1> wide = (input * (1/input_scale)).array().rint().cwiseMax(-127).cwiseMin(127).template cast<int32_t>();
+		alignas(32) std::array<int8_t, PaddedInputs> q {};
+		for(int c = 0; c < NumInputs; ++c) q[c] = (int8_t)wide(c);
+
+		Eigen::Matrix<int32_t, NumOutputs, 1> sums;
+		products(q.data(), sums.data());
+		return (sums.template cast<ScalarType>().cwiseProduct(row_scale) * input_scale).unaryExpr(&Activation::eval);
+	}
+
+	template <int Cols>
+	Eigen::Matrix<ScalarType, NumOutputs, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, NumInputs, Cols>& input) const
+	{
+		Eigen::Matrix<ScalarType, NumOutputs, Cols> res(NumOutputs, input.cols());
+		for(Eigen::Index c = 0; c < input.cols(); ++c) res.col(c) = feed_forward(input.col(c));
+		return res;
+	}
+
+	const WeightType& get_weight() const { return weight; }
+	const ScaleType& get_row_scale() const { return row_scale; }
+	ScalarType get_input_scale() const { return input_scale; }
+
+	// Bytes of parameters, the weights without padding and the scales.
+	static constexpr size_t parameter_bytes = NumOutputs*NumInputs + (NumOutputs + 1)*sizeof(ScalarType);
+
+private :
+	// sums(r) = q(r, .) . x for every row r.
+	void products(const int8_t* x, int32_t* sums) const
+	{
+#if defined(__AVX2__)
+		constexpr int blocked = NumOutputs/4*4;
+		
+		// Four rows at a time share the loads of the input and one horizontal sum.
+		[[maybe_unused]] const __m256i ones = _mm256_set1_epi16(1);
+		for(int r = 0; r < blocked; r += 4)
+		{
+			__m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+			for(int k = 0; k < PaddedInputs; k += 32)
+			{
+				__m256i a = _mm256_load_si256((const __m256i*)(x + k));
+				__m256i magnitude = _mm256_sign_epi8(a, a);
+				for(int i = 0; i < 4; ++i)
+				{
+					__m256i b = _mm256_loadu_si256((const __m256i*)(weight.row(r+i).data() + k));
+#if defined(__AVXVNNI__)
+					acc[i] = _mm256_dpbusd_avx_epi32(acc[i], magnitude, _mm256_sign_epi8(b, a));
+#elif defined(__AVX512VNNI__) && defined(__AVX512VL__)
+					acc[i] = _mm256_dpbusd_epi32(acc[i], magnitude, _mm256_sign_epi8(b, a));
+#else
+					acc[i] = _mm256_add_epi32(acc[i], _mm256_madd_epi16(_mm256_maddubs_epi16(magnitude, _mm256_sign_epi8(b, a)), ones));
+#endif
+				}
+			}
+			__m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(acc[0], acc[1]), _mm256_hadd_epi32(acc[2], acc[3]));
+			__m128i four = _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+			_mm_storeu_si128((__m128i*)(sums + r), four);
+		}
+#else
+		constexpr int blocked = 0;
+#endif
+		for(int r = blocked; r < NumOutputs; ++r)
+		{
+			const int8_t* row = weight.row(r).data();
+			int32_t sum = 0;
+			for(int k = 0; k < PaddedInputs; ++k) sum += (int32_t)row[k] * x[k];
+			sums[r] = sum;
+		}
+	}
+
+	WeightType weight;
+	ScaleType row_scale;
+	ScalarType input_scale = 1;
+};
+
+template <int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
+constexpr bool is_layer<QuantizedLayer<NumInputs, NumOutputs, ActivationFunction>> = true;
+
+/* Quantized Networks */
+
+template <typename LayerT>
+struct quantized;
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation, typename Storage>
+struct quantized<PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation, Storage>> {
+	using type = QuantizedLayer<NumInputs, NumOutputs, Activation>;
+};
+
+template <typename... Layers>
+struct quantized<NeuralNetwork<Layers...>> {
+	using type = NeuralNetwork<typename quantized<Layers>::type...>;
+};
+
+template <typename T>
+using quantized_t = typename quantized<T>::type;
+
+/*
+ *  Calibration.
+ *
+ *  Quantizes the weights of a trained network and sets the input range of every layer
+ *  to the largest input that layer sees when samples are fed through the network in
+ *  full precision.
+ */
+
+template <typename... Layers>
+quantized_t<NeuralNetwork<Layers...>> calibrate(const NeuralNetwork<Layers...>& nn, const std::vector<typename NeuralNetwork<Layers...>::InputType>& samples)
+{
+	using QuantizedType = quantized_t<NeuralNetwork<Layers...>>;
+	constexpr size_t number_of_layers = sizeof...(Layers);
+	QuantizedType res;
+	std::array<double, number_of_layers> largest {};
+
+	for(const auto& sample : samples)
+	{
+		auto step = [&]<size_t N>(auto& self, const auto& input, std::integral_constant<size_t, N>) -> void {
+			largest[N] = std::max<double>(largest[N], input.cwiseAbs().maxCoeff());
+			if constexpr (N + 1 < number_of_layers)
+				self(self, std::get<N>(nn.layers).feed_forward(input), std::integral_constant<size_t, N+1>{});
+		};
+		step(step, sample, std::integral_constant<size_t, 0>{});
+	}
+
+	[&]<size_t... N>(std::index_sequence<N...>) {
+		((std::get<N>(res.layers) = typename QuantizedType::template LayerType<N>(std::get<N>(nn.layers)),
+		  std::get<N>(res.layers).set_input_range(largest[N])), ...);
+	}(std::make_index_sequence<number_of_layers>{});
+	return res;
+}
+
+}
+
+#endif /* SRC_QUANTIZED_LAYER_HPP_ */
@@ -0,0 +1,258 @@
+/*
+ * racing.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_RACING_HPP_
+#define SRC_RACING_HPP_
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <numeric>
+#include <algorithm>
+
+#include "profiler.hpp"
+#include "trace.hpp"
+
+namespace neural
+{
+
+/*
+ *  Racing.
+ *
+ *  One episode is a noisy score, and giving every network the same large number of
+ *  episodes multiplies the cost. A race gives every network min_episodes episodes, then
+ *  keeps going only with the networks it cannot yet place on either side of the
+ *  selection cutoff, the number_selected-th best mean, up to max_episodes.
+ *
+ *  Episode e uses seed seed + e for every network (common random numbers), so two
+ *  networks are compared on the same games. Network i is placed once the mean of its
+ *  paired differences with the network at the cutoff, over the episodes both played,
+ *  is further from 0 than z standard errors or the standard error is at most
+ *  indifference. The cutoff network plays on for as long as any other is undecided.
+ *
+ *  Episodes are handed out as trials in rounds. next() waits while a round is still
+ *  being scored elsewhere, so the same race can be run by one loop (next, play,
+ *  report) or by several threads, see run().
+ */
+
+// A mean over episodes as a score, rounded only when scores are integers.
+template <typename ScoreType>
+ScoreType to_score(double mean)
+{
+	if constexpr (std::is_integral_v<ScoreType>) return static_cast<ScoreType>(std::round(mean));
+	else return static_cast<ScoreType>(mean);
+}
+
+class Race
+{
+public :
+	struct Trial {
+		size_t individual = 0;
+		uint32_t episode = 0;
+		uint32_t seed = 0;
+	};
+
+	Race(size_t population_size, size_t number_selected_, int min_episodes_ = 4, int max_episodes_ = 20, uint32_t seed_ = 0)
+		: number_selected{number_selected_}
+		, min_episodes{min_episodes_}
+		, max_episodes{max_episodes_}
+		, seed{seed_}
+		, scores(population_size)
+	{
+		assert(number_selected >= 1 && number_selected <= population_size);
+		assert(min_episodes >= 1 && max_episodes >= min_episodes);
+		for(size_t i = 0; i < population_size; ++i)
+			for(int e = 0; e < min_episodes; ++e) schedule(i, e);
+	}
+
+	// Waits for the next trial. False once the race is over.
+	bool next(Trial& trial)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		ready.wait(lock, [this]() { return finished || !pending.empty(); });
+		if(pending.empty()) return false;
+		trial = pending.front();
+		pending.pop_front();
+		++outstanding;
+		return true;
+	}
+
+	void report(const Trial& trial, double score)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& s = scores[trial.individual];
+		if(s.size() <= trial.episode) s.resize(trial.episode + 1);
+		s[trial.episode] = score;
+		++episodes_used;
+		if(--outstanding == 0 && pending.empty()) next_round();
+	}
+
+	// Runs the whole race on number_of_threads threads. scorer(network, seed) plays one episode.
+	template <typename ScorerT, typename PopulationType>
+	void run(std::vector<PopulationType>& population, const ScorerT& scorer, int number_of_threads = 1)
+	{
+		TraceSpan span("race", "racing", "population", population.size());
+		assert(population.size() == scores.size());
+		auto evaluator = [this, &population, &scorer]() {
+			ScorerT local_scorer = scorer;
+			Trial trial;
+			while(next(trial))
+			{
+				double score;
+				{
+					ProfileScope scope(ProfilePhase::Evaluation);
+					score = local_scorer(*population[trial.individual].first, trial.seed);
+				}
+				report(trial, score);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(int t = 1; t < number_of_threads; ++t) threads.emplace_back(evaluator);
+		evaluator();
+		for(auto& thread : threads) thread.join();
+
+		std::vector<double> m = means();
+		for(size_t i = 0; i < population.size(); ++i) population[i].second = to_score<decltype(population[i].second)>(m[i]);
+	}
+
+	bool is_finished() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return finished;
+	}
+
+	// Mean score of every network over the episodes it played.
+	std::vector<double> means() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<double> res(scores.size());
+		for(size_t i = 0; i < scores.size(); ++i) res[i] = mean(i);
+		return res;
+	}
+
+	std::vector<int> episodes() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<int> res(scores.size());
+		for(size_t i = 0; i < scores.size(); ++i) res[i] = scores[i].size();
+		return res;
+	}
+
+	size_t get_episodes_used() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return episodes_used;
+	}
+
+public :
+	double z = 1.0;
+	double indifference = 0;
+
+private :
+	void schedule(size_t i, int e)
+	{
+		pending.push_back({i, (uint32_t)e, seed + e});
+	}
+
+	double mean(size_t i) const
+	{
+		const auto& s = scores[i];
+		return s.empty() ? 0 : std::accumulate(s.begin(), s.end(), 0.0)/s.size();
+	}
+
+	// Called with mutex held once every trial of the round is in.
+	void next_round()
+	{
+		TraceSpan span("next round", "racing");
+		size_t n = scores.size();
+		std::vector<double> m(n);
+		for(size_t i = 0; i < n; ++i) m[i] = mean(i);
+		std::vector<size_t> order(n);
+		std::iota(order.begin(), order.end(), 0);
+		std::nth_element(order.begin(), order.begin() + (number_selected-1), order.end(), [&m](size_t a, size_t b) { return m[a] > m[b]; });
+		size_t cutoff = order[number_selected-1];
+
+		// Two episodes of integer scores often differ by the same amount, which alone would
+		// look certain. The variance of the differences is at least their pooled variance.
+		double pooled = 0;
+		size_t degrees_of_freedom = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			if(i == cutoff) continue;
+			Difference d = difference(i, cutoff);
+			if(d.shared < 2) continue;
+			pooled += d.variance * (d.shared - 1);
+			degrees_of_freedom += d.shared - 1;
+		}
+		if(degrees_of_freedom) pooled /= degrees_of_freedom;
+
+		bool any = false;
+		for(size_t i = 0; i < n; ++i)
+		{
+			if(i == cutoff || (int)scores[i].size() >= max_episodes || decided(i, cutoff, pooled)) continue;
+			schedule(i, scores[i].size());
+			any = true;
+		}
+		if(any && (int)scores[cutoff].size() < max_episodes) schedule(cutoff, scores[cutoff].size());
+
+		finished = pending.empty();
+		ready.notify_all();
+	}
+
+	struct Difference {
+		size_t shared;
+		double gap;
+		double variance;
+	};
+
+	// Mean and variance of the score of i minus the score of cutoff over the episodes both played.
+	Difference difference(size_t i, size_t cutoff) const
+	{
+		size_t shared = std::min(scores[i].size(), scores[cutoff].size());
+		double sum = 0, sum_of_squares = 0;
+		for(size_t e = 0; e < shared; ++e)
+		{
+			double d = scores[i][e] - scores[cutoff][e];
+			sum += d;
+			sum_of_squares += d*d;
+		}
+		double gap = shared ? sum/shared : 0;
+		double variance = (shared > 1) ? std::max(0.0, (sum_of_squares - shared*gap*gap)/(shared - 1)) : 0;
+		return {shared, gap, variance};
+	}
+
+	bool decided(size_t i, size_t cutoff, double pooled) const
+	{
+		Difference d = difference(i, cutoff);
+		if(d.shared < 2) return false;
+		double standard_error = std::sqrt(std::max(d.variance, pooled)/d.shared);
+		return standard_error <= indifference || std::abs(d.gap) > z * standard_error;
+	}
+
+	size_t number_selected;
+	int min_episodes;
+	int max_episodes;
+	uint32_t seed;
+
+	mutable std::mutex mutex;
+	std::condition_variable ready;
+	std::vector<std::vector<double>> scores;	// Episode scores of every network.
+	std::deque<Trial> pending;
+	size_t outstanding = 0;
+	size_t episodes_used = 0;
+	bool finished = false;
+};
+
+}
+
+#endif /* SRC_RACING_HPP_ */
@@ -0,0 +1,264 @@
+/*
+ * recurrent_layer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_RECURRENT_LAYER_HPP_
+#define SRC_RECURRENT_LAYER_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cassert>
+#include <fstream>
+#include <type_traits>
+
+#include "concepts.hpp"
+#include "math_functions.hpp"
+#include "perceptron_layer.hpp"
+
+namespace neural
+{
+
+/*
+ *  Recurrent layers.
+ *
+ *  Layers with memory. The hidden state is a StateType the caller holds, one fixed-size
+ *  vector per layer in NeuralNetwork::StateType, so a tick allocates nothing and the
+ *  network itself stays read-only: a genome shared by several games is played with one
+ *  state per game. NeuralNetwork::step runs one tick; feed_forward runs from a zero
+ *  state, as if every input were the first.
+ *
+ *  All the weights of a layer are one matrix, the input weights in the first InputSize
+ *  columns and the recurrent weights after them, so initializers, mutation, crossover
+ *  and checkpoints treat them like those of any other layer. A tick is then a single
+ *  product with the input and the state stacked.
+ *
+ *  feed_forward_sequence runs a whole sequence, one column per tick. The input weights
+ *  multiply every tick at once in one product; only the recurrent weights are left to
+ *  apply tick by tick.
+ */
+
+/* Elman Layer */
+
+// h = f(W_x x + W_h h)
+template <typename Scalar, int NumInputs, int NumHidden, template<typename> class ActivationFunction, typename Storage = Scalar>
+class ElmanLayer
+{
+public :
+	static_assert(NumInputs > 0 && NumHidden > 0);
+	using ScalarType  = Scalar;
+	using StorageType = Storage;
+	static constexpr int InputSize = NumInputs;
+	static constexpr int OutputSize = NumHidden;
+
+	static constexpr bool HasParameters = true;
+	static constexpr bool Compressed = !std::is_same_v<StorageType, ScalarType>;
+
+	using InputType  = Eigen::Matrix<ScalarType, NumInputs, 1>;
+	using OutputType = Eigen::Matrix<ScalarType, NumHidden, 1>;
+	using StateType  = Eigen::Matrix<ScalarType, NumHidden, 1>;
+	using WeightType = Eigen::Matrix<StorageType, NumHidden, NumInputs + NumHidden>;
+	using Activation = ActivationFunction<ScalarType>;
+public :
+	ElmanLayer() {}
+	ElmanLayer(WeightType w_) : weight(w_) {};
+
+	template <typename Initializer>
+	void initialize(Initializer& init) { init.initialize(*this); }
+
+	OutputType feed_forward(const InputType& input) const
+	{
+		return (widened().template leftCols<NumInputs>() * input).unaryExpr(&Activation::eval);
+	}
+
+	// Every column from a zero state.
+	template <int Cols>
+	Eigen::Matrix<ScalarType, NumHidden, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, NumInputs, Cols>& input) const
+	{
+		return (widened().template leftCols<NumInputs>() * input).unaryExpr(&Activation::eval);
+	}
+
+	OutputType step(const InputType& input, StateType& state) const
+	{
+		Eigen::Matrix<ScalarType, NumInputs + NumHidden, 1> stacked;
+		stacked << input, state;
+		state = (widened() * stacked).unaryExpr(&Activation::eval);
+		return state;
+	}
+
+	template <int Steps>
+	Eigen::Matrix<ScalarType, NumHidden, Steps> feed_forward_sequence(const Eigen::Matrix<ScalarType, NumInputs, Steps>& inputs, StateType& state) const
+	{
+		decltype(auto) w = widened();
+		Eigen::Matrix<ScalarType, NumHidden, Steps> res = w.template leftCols<NumInputs>() * inputs;
+		for(Eigen::Index t = 0; t < inputs.cols(); ++t)
+		{
+			res.col(t).noalias() += w.template rightCols<NumHidden>() * state;
+			state = res.col(t).unaryExpr(&Activation::eval);
+			res.col(t) = state;
+		}
+		return res;
+	}
+
+	inline WeightType& get_weight() { return weight; }
+
+	inline const WeightType& get_weight() const { return weight; }
+
+private :
+	decltype(auto) widened() const
+	{
+		if constexpr (Compressed) return widen<ScalarType>(weight);
+		else return (weight);
+	}
+
+	WeightType weight;
+};
+
+/* GRU Layer */
+
+// Gated recurrent unit, the rows of the weights in three blocks of NumHidden:
+//   z = sigmoid(W_z x + U_z h)				update gate
+//   r = sigmoid(W_r x + U_r h)				reset gate
+//   n = tanh(W_n x + r * (U_n h))			candidate
+//   h = (1 - z) * n + z * h
+// The gates are fixed, so they use Eigen's vectorized logistic and tanh.
+template <typename Scalar, int NumInputs, int NumHidden, typename Storage = Scalar>
+class GRULayer
+{
+public :
+	static_assert(NumInputs > 0 && NumHidden > 0);
+	using ScalarType  = Scalar;
+	using StorageType = Storage;
+	static constexpr int InputSize = NumInputs;
+	static constexpr int OutputSize = NumHidden;
+
+	static constexpr bool HasParameters = true;
+	static constexpr bool Compressed = !std::is_same_v<StorageType, ScalarType>;
+
+	using InputType  = Eigen::Matrix<ScalarType, NumInputs, 1>;
+	using OutputType = Eigen::Matrix<ScalarType, NumHidden, 1>;
+	using StateType  = Eigen::Matrix<ScalarType, NumHidden, 1>;
+	using WeightType = Eigen::Matrix<StorageType, 3*NumHidden, NumInputs + NumHidden>;
+	using GateType   = Eigen::Matrix<ScalarType, 3*NumHidden, 1>;
+public :
+	GRULayer() {}
+	GRULayer(WeightType w_) : weight(w_) {};
+
+	template <typename Initializer>
+	void initialize(Initializer& init) { init.initialize(*this); }
+
+	// From a zero state U h is 0, and so is what the update gate keeps of it.
+	OutputType feed_forward(const InputType& input) const
+	{
+		GateType x = widened().template leftCols<NumInputs>() * input;
+		return ((1 - x.template head<NumHidden>().array().logistic())
+			* x.template tail<NumHidden>().array().tanh()).matrix();
+	}
+
+	template <int Cols>
+	Eigen::Matrix<ScalarType, NumHidden, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, NumInputs, Cols>& input) const
+	{
+		Eigen::Matrix<ScalarType, 3*NumHidden, Cols> x = widened().template leftCols<NumInputs>() * input;
+		return ((1 - x.template topRows<NumHidden>().array().logistic())
+			* x.template bottomRows<NumHidden>().array().tanh()).matrix();
+	}
+
+	OutputType step(const InputType& input, StateType& state) const
+	{
+		decltype(auto) w = widened();
+		GateType x = w.template leftCols<NumInputs>() * input;
+		GateType h = w.template rightCols<NumHidden>() * state;
+		update(x, h, state);
+		return state;
+	}
+
+	template <int Steps>
+	Eigen::Matrix<ScalarType, NumHidden, Steps> feed_forward_sequence(const Eigen::Matrix<ScalarType, NumInputs, Steps>& inputs, StateType& state) const
+	{
+		decltype(auto) w = widened();
+		Eigen::Matrix<ScalarType, 3*NumHidden, Steps> x = w.template leftCols<NumInputs>() * inputs;
+		Eigen::Matrix<ScalarType, NumHidden, Steps> res(NumHidden, inputs.cols());
+		GateType h;
+		for(Eigen::Index t = 0; t < inputs.cols(); ++t)
+		{
+			h.noalias() = w.template rightCols<NumHidden>() * state;
+			update(x.col(t), h, state);
+			res.col(t) = state;
+		}
+		return res;
+	}
+
+	inline WeightType& get_weight() { return weight; }
+
+	inline const WeightType& get_weight() const { return weight; }
+
+private :
+	// x and h are the input and the recurrent products of all three gates.
+	template <typename X, typename H>
+	static void update(const X& x, const H& h, StateType& state)
+	{
+		OutputType z = (x.template head<NumHidden>() + h.template head<NumHidden>()).array().logistic();
+		OutputType r = (x.template segment<NumHidden>(NumHidden) + h.template segment<NumHidden>(NumHidden)).array().logistic();
+		OutputType n = (x.template tail<NumHidden>().array() + r.array() * h.template tail<NumHidden>().array()).tanh();
+		state = n.array() + z.array() * (state.array() - n.array());
+	}
+
+	decltype(auto) widened() const
+	{
+		if constexpr (Compressed) return widen<ScalarType>(weight);
+		else return (weight);
+	}
+
+	WeightType weight;
+};
+
+/* Reading and Writing */
+
+template <typename Scalar, int NumInputs, int NumHidden, template<typename> class Activation, typename Storage>
+void read_from_file(std::ifstream& file, ElmanLayer<Scalar, NumInputs, NumHidden, Activation, Storage>& layer)
+{
+	read_weights(file, layer.get_weight());
+}
+
+template <typename Scalar, int NumInputs, int NumHidden, template<typename> class Activation, typename Storage>
+void save_to_file(std::ofstream& file, const ElmanLayer<Scalar, NumInputs, NumHidden, Activation, Storage>& layer)
+{
+	save_weights(file, layer.get_weight());
+}
+
+template <typename Scalar, int NumInputs, int NumHidden, typename Storage>
+void read_from_file(std::ifstream& file, GRULayer<Scalar, NumInputs, NumHidden, Storage>& layer)
+{
+	read_weights(file, layer.get_weight());
+}
+
+template <typename Scalar, int NumInputs, int NumHidden, typename Storage>
+void save_to_file(std::ofstream& file, const GRULayer<Scalar, NumInputs, NumHidden, Storage>& layer)
+{
+	save_weights(file, layer.get_weight());
+}
+
+/* Specializations */
+
+template <int NumInputs, int NumHidden>
+using ElmanSigmoidLayer = ElmanLayer<double, NumInputs, NumHidden, sigmoid>;
+
+template <int NumInputs, int NumHidden>
+using ElmanTanhLayer = ElmanLayer<double, NumInputs, NumHidden, tanh>;
+
+template <int NumInputs, int NumHidden>
+using GRULayerD = GRULayer<double, NumInputs, NumHidden>;
+
+/* Type Traits */
+
+template <typename Scalar, int NumInputs, int NumHidden, template<typename> class ActivationFunction, typename Storage>
+constexpr bool is_layer<ElmanLayer<Scalar, NumInputs, NumHidden, ActivationFunction, Storage>> = true;
+
+template <typename Scalar, int NumInputs, int NumHidden, typename Storage>
+constexpr bool is_layer<GRULayer<Scalar, NumInputs, NumHidden, Storage>> = true;
+
+}
+
+#endif /* SRC_RECURRENT_LAYER_HPP_ */
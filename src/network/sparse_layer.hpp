@@ -0,0 +1,251 @@
+/*
+ * sparse_layer.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_SPARSE_LAYER_HPP_
+#define SRC_SPARSE_LAYER_HPP_
+
+#include <Eigen/Dense>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <type_traits>
+
+#include "concepts.hpp"
+#include "perceptron_layer.hpp"
+#include "plain_neural_network.hpp"
+
+namespace neural
+{
+
+/*
+ *  Sparse layer.
+ *
+ *  An inference-only PerceptronLayer for pruned weights, see pruning.hpp. The weights
+ *  that are not 0 are kept in compressed sparse rows: the values and columns of row r
+ *  are at row_start[r] up to row_start[r+1]. Each output is then a gather over the
+ *  inputs that row uses, and the zeros cost neither time nor memory.
+ *
+ *  A gather does not vectorize, so a dense product is faster until most weights are
+ *  gone: about 95% of a float layer, 80% of a double one. The layer measures the
+ *  density of the weights it is built from and keeps them sparse only at max_density
+ *  or below, and dense otherwise. The choice is made once, so feed_forward branches on
+ *  a flag that never changes.
+ */
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
+class SparseLayer
+{
+public :
+	static_assert(NumInputs > 0 && NumOutputs > 0);
+	using ScalarType = Scalar;
+	static constexpr int InputSize = NumInputs;
+	static constexpr int OutputSize = NumOutputs;
+
+	static constexpr bool HasParameters = false;
+
+	using InputType  = Eigen::Matrix<ScalarType, NumInputs, 1>;
+	using OutputType = Eigen::Matrix<ScalarType, NumOutputs, 1>;
+	using WeightType = Eigen::Matrix<ScalarType, NumOutputs, NumInputs>;
+	using IndexType  = std::conditional_t<(NumInputs <= 65536), uint16_t, uint32_t>;
+	using Activation = ActivationFunction<ScalarType>;
+
+	// Where the sparse kernel starts to win on layers 64 to 256 wide, see src/examples/pruning.
+	// A float product vectorizes twice as wide as a double one, so it pays to go sparse later.
+	static constexpr double default_max_density = std::is_same_v<ScalarType, float> ? 0.05 : 0.2;
+
+public :
+	SparseLayer() : SparseLayer(WeightType::Zero()) {}
+
+	explicit SparseLayer(const WeightType& w, double max_density = default_max_density) { assign(w, max_density); }
+
+	// Compresses the weights of a trained layer, widened to Scalar if stored narrower.
+	template <typename S, template<typename> class A, typename Storage>
+	explicit SparseLayer(const PerceptronLayer<S, NumInputs, NumOutputs, A, Storage>& layer, double max_density = default_max_density)
+	{
+		assign(layer.get_weight().template cast<ScalarType>(), max_density);
+	}
+
+	OutputType feed_forward(const InputType& input) const
+	{
+		if(!sparse) return (dense()*input).unaryExpr(&Activation::eval);
+		OutputType res;
+		for(int r = 0; r < NumOutputs; ++r)
+		{
+			// Four partial sums, so the additions do not wait on one another.
+			ScalarType sum[4] = {0, 0, 0, 0};
+			uint32_t k = row_start[r], end = row_start[r+1];
+			for(; k + 4 <= end; k += 4)
+				for(int j = 0; j < 4; ++j) sum[j] += value[k+j] * input(column[k+j]);
+			for(; k < end; ++k) sum[0] += value[k] * input(column[k]);
+			res(r) = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+		}
+		return res.unaryExpr(&Activation::eval);
+	}
+
+	template <int Cols>
+	Eigen::Matrix<ScalarType, NumOutputs, Cols> feed_forward_batch(const Eigen::Matrix<ScalarType, NumInputs, Cols>& input) const
+	{
+		if(!sparse) return (dense()*input).unaryExpr(&Activation::eval);
+		Eigen::Matrix<ScalarType, NumOutputs, Cols> res = Eigen::Matrix<ScalarType, NumOutputs, Cols>::Zero(NumOutputs, input.cols());
+		for(int r = 0; r < NumOutputs; ++r)
+			for(uint32_t k = row_start[r]; k < row_start[r+1]; ++k) res.row(r) += value[k] * input.row(column[k]);
+		return res.unaryExpr(&Activation::eval);
+	}
+
+	// The weights as a dense matrix, zeros included.
+	WeightType get_weight() const
+	{
+		if(!sparse) return dense();
+		WeightType res = WeightType::Zero();
+		for(int r = 0; r < NumOutputs; ++r)
+			for(uint32_t k = row_start[r]; k < row_start[r+1]; ++k) res(r, column[k]) = value[k];
+		return res;
+	}
+
+	// Replaces the weights, measuring their density again.
+	void assign(const WeightType& w, double max_density_ = default_max_density)
+	{
+		max_density = max_density_;
+		size_t nonzero = (w.array() != ScalarType(0)).count();
+		sparse = nonzero <= max_density * w.size();
+		row_start.clear();
+		column.clear();
+		value.clear();
+		if(!sparse)
+		{
+			value.assign(w.data(), w.data() + w.size());
+			return;
+		}
+		row_start.reserve(NumOutputs + 1);
+		column.reserve(nonzero);
+		value.reserve(nonzero);
+		for(int r = 0; r < NumOutputs; ++r)
+		{
+			row_start.push_back(value.size());
+			for(int c = 0; c < NumInputs; ++c)
+			{
+				if(w(r, c) == ScalarType(0)) continue;
+				column.push_back(c);
+				value.push_back(w(r, c));
+			}
+		}
+		row_start.push_back(value.size());
+	}
+
+	bool is_sparse() const { return sparse; }
+	double get_max_density() const { return max_density; }
+	size_t number_of_nonzeros() const { return sparse ? value.size() : (get_weight().array() != ScalarType(0)).count(); }
+
+	// Bytes of parameters as held, the values and, when sparse, the indices.
+	size_t parameter_bytes() const
+	{
+		return value.size()*sizeof(ScalarType) + column.size()*sizeof(IndexType) + row_start.size()*sizeof(uint32_t);
+	}
+
+private :
+	Eigen::Map<const WeightType> dense() const { return Eigen::Map<const WeightType>(value.data()); }
+
+	bool sparse = false;
+	double max_density = default_max_density;
+	std::vector<uint32_t> row_start;
+	std::vector<IndexType> column;
+	std::vector<ScalarType> value;		// The nonzeros row by row, or all of the weights column-major when dense.
+};
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class ActivationFunction>
+constexpr bool is_layer<SparseLayer<Scalar, NumInputs, NumOutputs, ActivationFunction>> = true;
+
+// Sparse text format: one line per layer, the max_density the layer was built with and the
+// number of nonzeros, followed by an index and a value for each, comma separated. The index
+// of weight (r, c) is r*NumInputs + c. The layer reads back sparse or dense as it was saved.
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation>
+void read_from_file(std::ifstream& file, SparseLayer<Scalar, NumInputs, NumOutputs, Activation>& layer)
+{
+	if(!file.is_open()) return;
+	std::string line;
+	getline(file, line);
+	std::stringstream stream(line);
+	std::string entry;
+
+	typename SparseLayer<Scalar, NumInputs, NumOutputs, Activation>::WeightType w;
+	w.setZero();
+	std::string density;
+	if(!std::getline(stream, density, ',') || !std::getline(stream, entry, ','))
+	{
+		std::cout << "Empty sparse layer." << std::endl;
+		return;
+	}
+	double max_density = std::stod(density);
+	long nonzeros = std::stol(entry);
+	long i = 0;
+	std::string index;
+	while(std::getline(stream, index, ',') && std::getline(stream, entry, ','))
+	{
+		long k = std::stol(index);
+		assert(k >= 0 && k < NumInputs*NumOutputs);
+		w(k/NumInputs, k%NumInputs) = static_cast<Scalar>(std::stod(entry));
+		++i;
+	}
+	assert(i == nonzeros);
+	layer.assign(w, max_density);
+}
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation>
+void save_to_file(std::ofstream& file, const SparseLayer<Scalar, NumInputs, NumOutputs, Activation>& layer)
+{
+	if(!file.is_open()) return;
+	auto w = layer.get_weight();
+	std::streamsize precision = file.precision(std::numeric_limits<double>::max_digits10);
+	file << layer.get_max_density() << ", " << layer.number_of_nonzeros();
+	file.precision(std::numeric_limits<Scalar>::max_digits10);
+	for(int r = 0; r < NumOutputs; ++r)
+		for(int c = 0; c < NumInputs; ++c)
+			if(w(r, c) != Scalar(0)) file << ", " << r*NumInputs + c << ", " << w(r, c);
+	file << std::endl;
+	file.precision(precision);
+}
+
+/* Sparse Networks */
+
+template <typename LayerT>
+struct sparse;
+
+template <typename Scalar, int NumInputs, int NumOutputs, template<typename> class Activation, typename Storage>
+struct sparse<PerceptronLayer<Scalar, NumInputs, NumOutputs, Activation, Storage>> {
+	using type = SparseLayer<Scalar, NumInputs, NumOutputs, Activation>;
+};
+
+template <typename... Layers>
+struct sparse<NeuralNetwork<Layers...>> {
+	using type = NeuralNetwork<typename sparse<Layers>::type...>;
+};
+
+template <typename T>
+using sparse_t = typename sparse<T>::type;
+
+// The network with every layer sparse or dense by its own density, see SparseLayer.
+template <typename... Layers>
+sparse_t<NeuralNetwork<Layers...>> sparsify(const NeuralNetwork<Layers...>& nn, double max_density = sparse_t<NeuralNetwork<Layers...>>::template LayerType<0>::default_max_density)
+{
+	using SparseType = sparse_t<NeuralNetwork<Layers...>>;
+	SparseType res;
+	[&]<size_t... N>(std::index_sequence<N...>) {
+		((std::get<N>(res.layers) = typename SparseType::template LayerType<N>(std::get<N>(nn.layers), max_density)), ...);
+	}(std::make_index_sequence<sizeof...(Layers)>{});
+	return res;
+}
+
+}
+
+#endif /* SRC_SPARSE_LAYER_HPP_ */
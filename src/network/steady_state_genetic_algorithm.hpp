@@ -0,0 +1,197 @@
+/*
+ * steady_state_genetic_algorithm.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_STEADY_STATE_GENETIC_ALGORITHM_HPP_
+#define SRC_STEADY_STATE_GENETIC_ALGORITHM_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
+#include "genetic_algorithm_neural_network.hpp"
+#include "concurrent_queue.hpp"
+#include "counter_rng.hpp"
+#include "trace.hpp"
+
+namespace neural
+{
+
+/*
+ *  Steady-state genetic algorithm.
+ *
+ *  GeneticAlgorithm::evolve waits for the whole population to be scored, so a few long
+ *  episodes hold up every core. Here there are no generations: every score that comes
+ *  back is put in the pool right away, replacing the weakest of a random tournament if
+ *  it does at least as well, and tops up a queue of children bred from the pool as it
+ *  is at that moment. Evaluators take the next network from the queue, so they never
+ *  wait on each other.
+ *
+ *      SteadyStateGA<ScorerT, NN> steady(genetic_algorithm, 0.05);
+ *      steady.run(100000, 8);
+ *
+ *  or, from a loop that scores one network at a time,
+ *
+ *      steady.next(task);  ...  steady.report(task, score);
+ *
+ *  The pool is the population of the GeneticAlgorithm, which also does the crossover
+ *  and mutation. The networks in it are scored first, from the same queue. Every random
+ *  number is keyed by the birth number of the child, but which parents a child gets
+ *  depends on the order in which scores come back, so runs with several evaluators are
+ *  not repeatable.
+ */
+
+template <typename ScorerT, typename NN>
+class SteadyStateGA
+{
+public :
+	using GeneticAlgorithmType = GeneticAlgorithm<ScorerT, NN>;
+	using NetworkType          = NN;
+	using GenomeType           = typename GeneticAlgorithmType::GenomeType;
+	using ScoreType            = typename ScorerT::OutputType;
+
+	// A network to score. slot is its place in the population for the first scores, and -1 for a child.
+	struct Task {
+		GenomeType network;
+		uint32_t birth = 0;
+		int slot = -1;
+	};
+
+	SteadyStateGA(GeneticAlgorithmType& genetic_algorithm_, double rate_, size_t queue_depth_ = 2, int tournament_size_ = 3)
+		: genetic_algorithm{genetic_algorithm_}
+		, rate{rate_}
+		, queue_depth{queue_depth_}
+		, tournament_size{tournament_size_}
+	{
+		assert(genetic_algorithm.population_size >= 2 && tournament_size >= 2);
+		for(size_t i = 0; i < genetic_algorithm.population_size; ++i)
+			queue.push({genetic_algorithm.population[i].first, 0, (int)i});
+	}
+
+	// Waits for the next network to score. False once the run is over.
+	bool next(Task& task) { return queue.pop(task); }
+
+	void report(const Task& task, ScoreType score)
+	{
+		TraceSpan span("report", "steady state", "birth", task.birth);
+		std::vector<Task> children;
+		std::vector<std::pair<GenomeType, GenomeType>> parents;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto& population = genetic_algorithm.population;
+			if(task.slot >= 0)
+			{
+				population[task.slot].second = score;
+				members.push_back(task.slot);
+			}
+			else
+			{
+				size_t weakest = tournament(task.birth, 1, false);
+				if(!genetic_algorithm.scorer.compare(population[weakest].second, score))
+					population[weakest] = {task.network, score};
+				if(++births == limit)
+				{
+					queue.close(true);
+					return;
+				}
+			}
+			if(members.size() < 2) return;
+
+			// Parents are shared here and bred outside the lock.
+			size_t queued = queue.size();
+			for(size_t c = queued; c < queue_depth; ++c)
+			{
+				uint32_t birth = next_birth++;
+				size_t index1 = tournament(birth, 0, true), index2 = tournament(birth, 2, true);
+				for(uint32_t retry = 3; index1 == index2 && retry < 64; ++retry) index2 = tournament(birth, retry, true);
+				parents.push_back({population[index1].first, population[index2].first});
+				children.push_back({GenomeType{}, birth, -1});
+			}
+		}
+
+		for(size_t c = 0; c < children.size(); ++c)
+		{
+			NetworkType other;
+			NetworkType& child = children[c].network.write();
+			genetic_algorithm.get_child(*parents[c].first, *parents[c].second, child, other, children[c].birth);
+			genetic_algorithm.mutate(child, rate, children[c].birth);
+			queue.push(std::move(children[c]));
+		}
+	}
+
+	// Scores number_of_births children on number_of_threads threads, each with its own
+	// copy of the scorer. The queue is closed at the end, so this is done once.
+	void run(size_t number_of_births, int number_of_threads)
+	{
+		TraceSpan span("steady state run", "steady state", "births", number_of_births);
+		limit = number_of_births;
+		queue_depth = std::max<size_t>(queue_depth, number_of_threads);
+
+		auto evaluator = [this]() {
+			ScorerT scorer = genetic_algorithm.scorer;
+			Task task;
+			while(next(task))
+			{
+				ScoreType score;
+				{
+					ProfileScope scope(ProfilePhase::Evaluation);
+					score = scorer(*task.network);
+				}
+				report(task, score);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(int t = 1; t < number_of_threads; ++t) threads.emplace_back(evaluator);
+		evaluator();
+		for(auto& thread : threads) thread.join();
+		++genetic_algorithm.generation;
+	}
+
+	// Number of children scored so far.
+	size_t get_births() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return births;
+	}
+
+private :
+	// Index of the best (or, with best false, the worst) of tournament_size scored
+	// networks, drawn with keyed uniforms. Call with mutex held.
+	size_t tournament(uint32_t birth, uint32_t round, bool best)
+	{
+		ProfileScope scope(ProfilePhase::Selection);
+		const auto& population = genetic_algorithm.population;
+		size_t winner = 0;
+		for(int k = 0; k < tournament_size; ++k)
+		{
+			double u = genetic_algorithm.rng.uniform(RandomStream::Selection, genetic_algorithm.generation, birth, round, k);
+			size_t index = members[std::min<size_t>(u * members.size(), members.size()-1)];
+			if(k == 0 || genetic_algorithm.scorer.compare(population[index].second, population[winner].second) == best) winner = index;
+		}
+		return winner;
+	}
+
+	GeneticAlgorithmType& genetic_algorithm;
+	double rate;
+	size_t queue_depth;
+	int tournament_size;
+
+	ConcurrentQueue<Task> queue;
+	mutable std::mutex mutex;		// Guards the population and everything below.
+	std::vector<size_t> members;	// Slots that have a score.
+	size_t births = 0;
+	size_t limit = 0;				// 0 runs until the program stops.
+	uint32_t next_birth = 0;
+};
+
+}
+
+#endif /* SRC_STEADY_STATE_GENETIC_ALGORITHM_HPP_ */
@@ -0,0 +1,105 @@
+/*
+ * surrogate.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_SURROGATE_HPP_
+#define SRC_SURROGATE_HPP_
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "plain_neural_network.hpp"
+#include "counter_rng.hpp"
+#include "../linear_regression/least_squares.hpp"
+
+namespace neural
+{
+
+/*
+ *  Surrogate fitness model.
+ *
+ *  A cheap guess at the score of a network before it plays. The weights of every layer,
+ *  flattened, are mapped to Projections features by a fixed Gaussian random projection
+ *  (Johnson-Lindenstrauss), and a ridge regression is fitted to the (features, score)
+ *  pairs of the last generation. train() adds a pair, fit() solves and starts the next
+ *  window.
+ *
+ *  Only the last generation is used on purpose: the score is far from linear in the
+ *  weights over the whole run, but close enough around the current population. A model
+ *  fitted to every generation, even with forgetting, predicted no better than chance.
+ *
+ *  GeneticAlgorithm::evolve_screened uses it to play only the children it predicts best.
+ */
+
+template <typename NN, unsigned int Projections = 32, typename ModelType = NormalEquationLinearModel<double, Projections, 1>>
+class Surrogate
+{
+public :
+	using NetworkType = NN;
+	using FeatureType = Eigen::Matrix<double, Projections, 1>;
+
+	Surrogate(ModelType model_ = ModelType(1e-3), uint64_t seed = 0)
+		: model{model_}
+	{
+		size_t number_of_parameters = 0;
+		NetworkType nn;
+		for_each_layer(nn, [&number_of_parameters](size_t, const auto& layer) { number_of_parameters += layer.get_weight().size(); });
+
+		CounterRNG rng(seed);
+		projection.resize(Projections, number_of_parameters);
+		for(Eigen::Index c = 0; c < projection.cols(); ++c)
+			for(unsigned int r = 0; r < Projections; ++r)
+				projection(r, c) = rng.normal(RandomStream::Projection, 0, 0, r, c) / std::sqrt((double)Projections);
+	}
+
+	FeatureType features(const NetworkType& nn) const
+	{
+		FeatureType res = FeatureType::Zero();
+		Eigen::Index offset = 0;
+		for_each_layer(nn, [this, &res, &offset](size_t, const auto& layer) {
+			const auto& w = layer.get_weight();
+			using StorageType = typename std::decay_t<decltype(w)>::Scalar;
+			res.noalias() += projection.middleCols(offset, w.size()) * Eigen::Map<const Eigen::Matrix<StorageType, Eigen::Dynamic, 1>>(w.data(), w.size()).template cast<double>();
+			offset += w.size();
+		});
+		return res;
+	}
+
+	void train(const NetworkType& nn, double score)
+	{
+		typename ModelType::OutputType actual;
+		actual << score;
+		model.train(features(nn), actual);
+		++number_of_samples;
+	}
+
+	// Solves for the pairs since the last fit. Keeps the previous model if there are too few.
+	bool fit()
+	{
+		bool solved = number_of_samples > Projections && model.solve();
+		model.equations.clear();
+		number_of_samples = 0;
+		fitted = fitted || solved;
+		return solved;
+	}
+
+	double predict(const NetworkType& nn) const { return model.predict(features(nn))(0); }
+
+	// False until a fit succeeded, and predictions are all 0.
+	bool is_fitted() const { return fitted; }
+
+private :
+	ModelType model;
+	Eigen::Matrix<double, Projections, Eigen::Dynamic> projection;
+	size_t number_of_samples = 0;
+	bool fitted = false;
+};
+
+}
+
+#endif /* SRC_SURROGATE_HPP_ */
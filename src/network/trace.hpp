@@ -0,0 +1,321 @@
+/*
+ * trace.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: reidharris
+ */
+
+#ifndef SRC_TRACE_HPP_
+#define SRC_TRACE_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+namespace neural
+{
+
+/*
+ *  Tracing.
+ *
+ *  Scoped spans written as Chrome trace JSON, which chrome://tracing and
+ *  ui.perfetto.dev open directly. trace_start(filename) starts recording and trace_stop()
+ *  writes the remaining events and closes the file.
+ *
+ *  Every thread appends complete events to its own single producer ring buffer without
+ *  locks. A background thread drains the rings into the file every flush interval, or
+ *  earlier when a ring is half full. If a ring still fills up, the newest events are
+ *  dropped and counted.
+ *  When tracing is off a span costs a relaxed atomic load and a branch.
+ *
+ *      {
+ *          TraceSpan span("evolve", "ga");
+ *          ...
+ *      }
+ *
+ *  Names, categories and argument names must be string literals, or otherwise outlive the trace.
+ */
+
+namespace trace_detail
+{
+
+struct Event {
+	const char* name;
+	const char* category;
+	const char* arg_name;
+	int64_t arg;
+	uint64_t start;
+	uint64_t duration;
+};
+
+inline uint64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// s as the contents of a JSON string. Returns s itself when nothing needs escaping, which
+// is the case for the string literals spans are named with, else scratch.
+inline const char* json_escape(const char* s, std::string& scratch)
+{
+	const char* c = s;
+	while(*c && *c != '"' && *c != '\\' && (unsigned char)*c >= 0x20) ++c;
+	if(!*c) return s;
+	scratch.assign(s, c);
+	for(; *c; ++c)
+	{
+		if(*c == '"' || *c == '\\')
+		{
+			scratch += '\\';
+			scratch += *c;
+		}
+		else if((unsigned char)*c < 0x20)
+		{
+			char code[8];
+			std::snprintf(code, sizeof(code), "\\u%04x", (unsigned char)*c);
+			scratch += code;
+		}
+		else scratch += *c;
+	}
+	return scratch.c_str();
+}
+
+struct Ring {
+	static constexpr size_t capacity = 1 << 16;
+
+	std::array<Event, capacity> events;
+	std::atomic<size_t> head {0};	// Written by the owning thread.
+	std::atomic<size_t> tail {0};	// Written by the flusher.
+	std::atomic<uint64_t> dropped {0};
+	int tid = 0;
+	std::string thread_name;
+	bool named = false;
+	std::condition_variable* wake = nullptr;
+
+	void push(const Event& e)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t used = h - tail.load(std::memory_order_acquire);
+		if(used == capacity)
+		{
+			dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+		events[h % capacity] = e;
+		head.store(h + 1, std::memory_order_release);
+		// Half full: flush early rather than wait for the next interval.
+		if(used == capacity/2) wake->notify_one();
+	}
+};
+
+struct Tracer {
+	std::atomic<bool> enabled {false};
+	std::mutex mutex;				// Guards rings, file and the flusher state, never taken by push.
+	std::condition_variable wake;
+	std::vector<std::shared_ptr<Ring>> rings;
+	std::ofstream file;
+	std::thread flusher;
+	std::chrono::milliseconds flush_interval {100};
+	uint64_t origin = 0;
+	bool first_event = true;
+	bool stopping = false;
+	int next_tid = 1;
+
+	static Tracer& instance()
+	{
+		static Tracer tracer;
+		return tracer;
+	}
+
+	std::shared_ptr<Ring> make_ring()
+	{
+		auto ring = std::make_shared<Ring>();
+		std::lock_guard<std::mutex> lock(mutex);
+		ring->tid = next_tid++;
+		ring->wake = &wake;
+		rings.push_back(ring);
+		return ring;
+	}
+
+	void write_event(const char* json)
+	{
+		file << (first_event ? "\n" : ",\n") << json;
+		first_event = false;
+	}
+
+	// Called with mutex held.
+	void drain()
+	{
+		char buffer[512];
+		std::string name, category, arg_name;
+		for(size_t r = 0; r < rings.size(); ++r)
+		{
+			Ring& ring = *rings[r];
+			if(!ring.named && !ring.thread_name.empty())
+			{
+				// Built as a string, a thread name can be longer than the buffer.
+				std::string event = "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(ring.tid)
+					+ ",\"args\":{\"name\":\"" + json_escape(ring.thread_name.c_str(), name) + "\"}}";
+				write_event(event.c_str());
+				ring.named = true;
+			}
+
+			size_t t = ring.tail.load(std::memory_order_relaxed);
+			size_t h = ring.head.load(std::memory_order_acquire);
+			for(; t != h; ++t)
+			{
+				const Event& e = ring.events[t % Ring::capacity];
+				double ts = (e.start - std::min(e.start, origin)) * 1e-3, dur = e.duration * 1e-3;
+				if(e.arg_name)
+					std::snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"%s\":%lld}}",
+								  json_escape(e.name, name), json_escape(e.category, category), ts, dur, ring.tid, json_escape(e.arg_name, arg_name), (long long)e.arg);
+				else
+					std::snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+								  json_escape(e.name, name), json_escape(e.category, category), ts, dur, ring.tid);
+				write_event(buffer);
+			}
+			ring.tail.store(t, std::memory_order_release);
+		}
+
+		// Forget the rings of threads that exited once they are empty.
+		for(size_t r = 0; r < rings.size();)
+		{
+			if(rings[r].use_count() == 1) rings.erase(rings.begin() + r);
+			else ++r;
+		}
+		file.flush();
+	}
+
+	void stop()
+	{
+		enabled.store(false, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!file.is_open()) return;
+			stopping = true;
+		}
+		wake.notify_all();
+		flusher.join();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		drain();
+		uint64_t dropped = 0;
+		for(auto& ring : rings) dropped += ring->dropped.exchange(0);
+		file << "\n]}" << std::endl;
+		file.close();
+		if(dropped) std::cout << "Trace: " << dropped << " events dropped, flush more often." << std::endl;
+	}
+
+	// A program that exits without trace_stop() still leaves a complete file.
+	~Tracer() { stop(); }
+
+	void flush_loop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while(!stopping)
+		{
+			wake.wait_for(lock, flush_interval);
+			drain();
+		}
+	}
+};
+
+inline Ring& local_ring()
+{
+	static thread_local std::shared_ptr<Ring> ring = Tracer::instance().make_ring();
+	return *ring;
+}
+
+}
+
+inline bool tracing() { return trace_detail::Tracer::instance().enabled.load(std::memory_order_relaxed); }
+
+// Starts writing a trace to filename. Returns false if the file cannot be opened or a trace is already running.
+inline bool trace_start(const std::string& filename, std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100))
+{
+	trace_detail::Tracer& tracer = trace_detail::Tracer::instance();
+	std::lock_guard<std::mutex> lock(tracer.mutex);
+	if(tracer.file.is_open()) return false;
+	tracer.file.open(filename, std::ios::out | std::ios::trunc);
+	if(!tracer.file.is_open())
+	{
+		std::cout << "File not open. Trace cannot be written." << std::endl;
+		return false;
+	}
+
+	// Events recorded before this trace are discarded.
+	for(auto& ring : tracer.rings)
+	{
+		ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+		ring->named = false;
+	}
+	tracer.file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	tracer.first_event = true;
+	tracer.stopping = false;
+	tracer.flush_interval = flush_interval;
+	tracer.origin = trace_detail::now_ns();
+	tracer.flusher = std::thread(&trace_detail::Tracer::flush_loop, &tracer);
+	tracer.enabled.store(true, std::memory_order_release);
+	return true;
+}
+
+// Stops the trace and writes the remaining events. Spans still open are not recorded.
+inline void trace_stop()
+{
+	trace_detail::Tracer::instance().stop();
+}
+
+// Names the calling thread in the trace viewer.
+inline void trace_thread_name(const std::string& name)
+{
+	trace_detail::Tracer& tracer = trace_detail::Tracer::instance();
+	trace_detail::Ring& ring = trace_detail::local_ring();
+	std::lock_guard<std::mutex> lock(tracer.mutex);
+	ring.thread_name = name;
+	ring.named = false;
+}
+
+/* Trace Span */
+
+class TraceSpan
+{
+public :
+	TraceSpan(const char* name_, const char* category_ = "neural", const char* arg_name_ = nullptr, int64_t arg_ = 0)
+	{
+		if(tracing())
+		{
+			event = {name_, category_, arg_name_, arg_, trace_detail::now_ns(), 0};
+			active = true;
+		}
+	}
+
+	~TraceSpan()
+	{
+		if(active && tracing())
+		{
+			event.duration = trace_detail::now_ns() - event.start;
+			trace_detail::local_ring().push(event);
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private :
+	trace_detail::Event event;
+	bool active = false;
+};
+
+}
+
+#endif /* SRC_TRACE_HPP_ */